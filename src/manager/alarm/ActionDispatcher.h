@@ -0,0 +1,178 @@
+// ActionDispatcher.h
+#pragma once
+#include "IAlarmAction.h"
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+
+// 异步告警动作分发器
+// 检查线程只把 (动作, 事件) 放入有界队列即返回，评估延迟与动作的快慢无关。
+// 工作线程每次取出一批，按动作实例分组后调用 executeBatch，使同一数据库/日志动作合并写入。
+// 队列满时丢弃新事件并计数，不阻塞检查线程。
+class ActionDispatcher {
+public:
+    struct Stats {
+        uint64_t enqueued = 0;
+        uint64_t dispatched = 0;
+        uint64_t dropped = 0;
+        uint64_t batches = 0;
+        size_t queueDepth = 0;
+        size_t maxQueueDepth = 0;
+    };
+
+private:
+    struct Item {
+        std::shared_ptr<IAlarmAction> action;
+        AlarmActionEvent event;
+    };
+
+    const size_t capacity_;
+    const size_t maxBatch_;
+    const size_t workerCount_;
+
+    std::deque<Item> queue_;
+    size_t maxQueueDepth_ = 0;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopRequested_ = false;
+    std::vector<std::thread> workers_;
+
+    std::atomic<uint64_t> enqueued_{0};
+    std::atomic<uint64_t> dispatched_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> batches_{0};
+
+    void run() {
+        std::vector<Item> batch;
+        while (true) {
+            batch.clear();
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return stopRequested_ || !queue_.empty(); });
+                if (queue_.empty()) break; // 停止且已排空
+                while (!queue_.empty() && batch.size() < maxBatch_) {
+                    batch.push_back(std::move(queue_.front()));
+                    queue_.pop_front();
+                }
+            }
+            dispatch(batch);
+        }
+    }
+
+    // 按动作实例分组，组内保持入队顺序
+    void dispatch(std::vector<Item>& batch) {
+        std::map<IAlarmAction*, std::vector<AlarmActionEvent>> groups;
+        std::vector<std::shared_ptr<IAlarmAction>> order;
+        for (auto& item : batch) {
+            auto& events = groups[item.action.get()];
+            if (events.empty()) {
+                order.push_back(item.action);
+            }
+            events.push_back(std::move(item.event));
+        }
+        for (const auto& action : order) {
+            const auto& events = groups[action.get()];
+            try {
+                action->executeBatch(events);
+            } catch (const std::exception& e) {
+                std::cerr << "[ActionDispatcher] Action failed: " << e.what() << std::endl;
+            }
+            dispatched_.fetch_add(events.size(), std::memory_order_relaxed);
+            batches_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    explicit ActionDispatcher(size_t capacity = 10000, size_t workerCount = 2, size_t maxBatch = 256)
+        : capacity_(capacity == 0 ? 1 : capacity), maxBatch_(maxBatch == 0 ? 1 : maxBatch),
+          workerCount_(workerCount == 0 ? 1 : workerCount) {}
+
+    ~ActionDispatcher() {
+        stop();
+    }
+
+    // 入队一次动作调用；队列已满时丢弃并返回false
+    bool enqueue(const std::shared_ptr<IAlarmAction>& action, AlarmActionEvent event) {
+        bool accepted;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            accepted = queue_.size() < capacity_;
+            if (accepted) {
+                queue_.push_back({action, std::move(event)});
+                if (queue_.size() > maxQueueDepth_) {
+                    maxQueueDepth_ = queue_.size();
+                }
+            }
+        }
+        if (!accepted) {
+            uint64_t dropped = dropped_.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (dropped == 1 || dropped % 1000 == 0) {
+                std::cerr << "[ActionDispatcher] Queue full, " << dropped << " alarm action(s) dropped so far." << std::endl;
+            }
+            return false;
+        }
+        enqueued_.fetch_add(1, std::memory_order_relaxed);
+        cv_.notify_one();
+        return true;
+    }
+
+    Stats getStats() {
+        Stats stats;
+        stats.enqueued = enqueued_.load(std::memory_order_relaxed);
+        stats.dispatched = dispatched_.load(std::memory_order_relaxed);
+        stats.dropped = dropped_.load(std::memory_order_relaxed);
+        stats.batches = batches_.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.queueDepth = queue_.size();
+        stats.maxQueueDepth = maxQueueDepth_;
+        return stats;
+    }
+
+    json getStatsJson() {
+        Stats stats = getStats();
+        return json{
+            {"enqueued", stats.enqueued},
+            {"dispatched", stats.dispatched},
+            {"dropped", stats.dropped},
+            {"batches", stats.batches},
+            {"queue_depth", stats.queueDepth},
+            {"max_queue_depth", stats.maxQueueDepth},
+            {"capacity", capacity_}
+        };
+    }
+
+    void start() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!workers_.empty()) return;
+        stopRequested_ = false;
+        for (size_t i = 0; i < workerCount_; ++i) {
+            workers_.emplace_back(&ActionDispatcher::run, this);
+        }
+        std::cout << "[ActionDispatcher] Started with " << workerCount_ << " worker(s)." << std::endl;
+    }
+
+    // 停止前执行完队列中剩余的动作
+    void stop() {
+        std::vector<std::thread> workers;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (workers_.empty()) return;
+            stopRequested_ = true;
+            workers.swap(workers_);
+        }
+        cv_.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        std::cout << "[ActionDispatcher] Stopped." << std::endl;
+    }
+};
@@ -6,21 +6,25 @@
 #include <utility>
 
 // 代表来自Agent的某个节点的特定指标
+// 节点与指标在构造时驻留为整数ID，取值时不再做字符串查找
 class AgentResource : public IResource {
 private:
     std::string nodeId_;
     std::string metricName_;
     std::shared_ptr<MetricCache> cache_;
+    MetricCache::NodeIndex node_;
+    MetricCache::MetricId metric_;
 
 public:
     AgentResource(std::string node, std::string metric, std::shared_ptr<MetricCache> c)
-        : nodeId_(std::move(node)), metricName_(std::move(metric)), cache_(std::move(c)) {}
+        : nodeId_(std::move(node)), metricName_(std::move(metric)), cache_(std::move(c)),
+          node_(cache_->internNode(nodeId_)), metric_(cache_->internMetric(metricName_)) {}
 
     double getValue() const override {
-        return cache_->getMetric(nodeId_, metricName_);
+        return cache_->getMetric(node_, metric_);
     }
 
     std::string getName() const override {
         return "Metric '" + metricName_ + "' on node '" + nodeId_ + "'";
     }
-};
\ No newline at end of file
+};
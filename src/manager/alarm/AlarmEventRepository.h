@@ -2,8 +2,18 @@
 #pragma once
 #include <SQLiteCpp/SQLiteCpp.h>
 #include <string>
+#include <vector>
+#include <memory>
 #include <mutex>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <sstream>
+#include <utility>
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
 
 // 告警事件类型
 enum class AlarmEventType {
@@ -11,10 +21,44 @@ enum class AlarmEventType {
     RECOVERED
 };
 
+// 一条待写入的告警事件
+struct AlarmEventRecord {
+    std::string ruleId;
+    std::string resourceName;
+    AlarmEventType eventType;
+    std::string details;
+    std::chrono::system_clock::time_point time;
+    std::vector<std::string> members;   // 风暴聚合事件涵盖的节点，写入 alarm_event_members
+};
+
+// 告警事件查询条件；空字符串或0表示不限制
+// 结果按 (timestamp, id) 倒序，cursor 为上一页返回的 next_cursor，用于键集分页
+struct AlarmEventQuery {
+    std::string ruleId;
+    std::string templateId;
+    std::string nodeId;
+    std::string eventType;   // "TRIGGERED" / "RECOVERED"
+    int64_t fromMs = 0;      // 包含
+    int64_t toMs = 0;        // 不包含
+    std::string cursor;
+    int limit = 100;
+};
+
+// 单次查询返回的最大条数（分组统计为最大组数），更大的 limit 按此截断
+const int kMaxAlarmEventQueryLimit = 1000;
+
 // 线程安全的数据库操作类
+// timestamp 列为 Unix 纪元毫秒整数，(rule_id, timestamp)、(template_id, timestamp)、
+// (node_id, timestamp) 与 timestamp 上有索引。
+// 模板生成的规则ID形如 "<templateId>:<nodeId>"，写入时拆分到 template_id / node_id 列。
+// 风暴聚合事件的规则ID为 "<templateId>:*"，node_id 留空，涵盖的节点逐个写入 alarm_event_members；
+// 按节点过滤与按节点分组时，聚合事件计入其每个成员节点。
+// 插入语句只在构造时准备一次，批量写入在一个事务内完成，只提交（落盘）一次。
 class AlarmEventRepository {
 private:
     SQLite::Database db_;
+    std::unique_ptr<SQLite::Statement> insertStmt_; // 受 dbMutex_ 保护
+    std::unique_ptr<SQLite::Statement> insertMemberStmt_; // 受 dbMutex_ 保护
     mutable std::mutex dbMutex_;
 
     // 将枚举转换为字符串
@@ -22,6 +66,233 @@ private:
         return (type == AlarmEventType::TRIGGERED) ? "TRIGGERED" : "RECOVERED";
     }
 
+    static int64_t toEpochMillis(std::chrono::system_clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+    }
+
+    void createTable() {
+        db_.exec(R"(
+            CREATE TABLE IF NOT EXISTS alarm_events (
+                id            INTEGER PRIMARY KEY AUTOINCREMENT,
+                timestamp     INTEGER NOT NULL,
+                rule_id       TEXT    NOT NULL,
+                resource_name TEXT    NOT NULL,
+                event_type    TEXT    NOT NULL CHECK(event_type IN ('TRIGGERED', 'RECOVERED')),
+                details       TEXT,
+                template_id   TEXT,
+                node_id       TEXT
+            );
+        )");
+    }
+
+    void createMemberTable() {
+        db_.exec(R"(
+            CREATE TABLE IF NOT EXISTS alarm_event_members (
+                event_id INTEGER NOT NULL REFERENCES alarm_events (id),
+                node_id  TEXT    NOT NULL,
+                PRIMARY KEY (event_id, node_id)
+            );
+        )");
+    }
+
+    bool hasColumn(const std::string& column) {
+        SQLite::Statement columns(db_, "PRAGMA table_info(alarm_events)");
+        while (columns.executeStep()) {
+            if (columns.getColumn("name").getString() == column) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 从形如 "<templateId>:<nodeId>" 的 rule_id 拆出模板与节点
+    void backfillRuleColumns() {
+        db_.exec(R"(
+            UPDATE alarm_events
+            SET template_id = substr(rule_id, 1, instr(rule_id, ':') - 1),
+                node_id     = substr(rule_id, instr(rule_id, ':') + 1)
+            WHERE instr(rule_id, ':') > 0
+        )");
+    }
+
+    // 旧版本没有 template_id / node_id 列，补列并从 rule_id 回填
+    void migrateRuleColumns() {
+        if (hasColumn("template_id")) return;
+        std::cout << "[DB] Adding template_id/node_id columns to alarm_events..." << std::endl;
+        SQLite::Transaction transaction(db_);
+        db_.exec("ALTER TABLE alarm_events ADD COLUMN template_id TEXT");
+        db_.exec("ALTER TABLE alarm_events ADD COLUMN node_id TEXT");
+        backfillRuleColumns();
+        transaction.commit();
+    }
+
+    // 旧版本把聚合事件的 node_id 记为 "*"，成员只出现在 details 中（"Grouped alarm of N nodes: a b c"），
+    // 拆出成员写入 alarm_event_members 并清空 node_id
+    void migrateStormMembers() {
+        std::vector<std::pair<int64_t, std::string>> storms;
+        {
+            SQLite::Statement select(db_, "SELECT id, details FROM alarm_events WHERE node_id = '*'");
+            while (select.executeStep()) {
+                storms.emplace_back(select.getColumn(0).getInt64(), select.getColumn(1).getString());
+            }
+        }
+        if (storms.empty()) return;
+
+        std::cout << "[DB] Moving members of " << storms.size() << " grouped alarm events to alarm_event_members..." << std::endl;
+        SQLite::Transaction transaction(db_);
+        SQLite::Statement insertMember(db_, "INSERT OR IGNORE INTO alarm_event_members (event_id, node_id) VALUES (?, ?)");
+        for (const auto& storm : storms) {
+            size_t colon = storm.second.find(':');
+            if (colon == std::string::npos) continue;
+            std::istringstream nodes(storm.second.substr(colon + 1));
+            std::string node;
+            while (nodes >> node) {
+                insertMember.reset();
+                insertMember.bind(1, static_cast<int64_t>(storm.first));
+                insertMember.bind(2, node);
+                insertMember.exec();
+            }
+        }
+        db_.exec("UPDATE alarm_events SET node_id = NULL WHERE node_id = '*'");
+        transaction.commit();
+    }
+
+    // 查询参数，按占位符顺序绑定
+    struct SqlArg {
+        bool isText;
+        std::string text;
+        int64_t number;
+    };
+
+    // 按查询条件拼接 WHERE 子句，参数按顺序追加到 args
+    // membersExpanded 为 true 时查询对象是按成员展开后的事件（见 countEvents），node_id 已是成员节点
+    static std::string buildWhere(const AlarmEventQuery& query, std::vector<SqlArg>& args, bool withCursor,
+                                  bool membersExpanded = false) {
+        std::vector<std::string> clauses;
+        auto addText = [&](const std::string& clause, const std::string& value) {
+            clauses.push_back(clause);
+            args.push_back({true, value, 0});
+        };
+        auto addNumber = [&](const std::string& clause, int64_t value) {
+            clauses.push_back(clause);
+            args.push_back({false, std::string(), value});
+        };
+        if (!query.ruleId.empty()) addText("rule_id = ?", query.ruleId);
+        if (!query.templateId.empty()) addText("template_id = ?", query.templateId);
+        if (!query.nodeId.empty()) {
+            if (membersExpanded) {
+                addText("node_id = ?", query.nodeId);
+            } else {
+                // 节点自身的事件，或以该节点为成员的聚合事件
+                addText("(node_id = ? OR id IN (SELECT event_id FROM alarm_event_members WHERE node_id = ?))",
+                        query.nodeId);
+                args.push_back({true, query.nodeId, 0});
+            }
+        }
+        if (!query.eventType.empty()) addText("event_type = ?", query.eventType);
+        if (query.fromMs > 0) addNumber("timestamp >= ?", query.fromMs);
+        if (query.toMs > 0) addNumber("timestamp < ?", query.toMs);
+        if (withCursor && !query.cursor.empty()) {
+            int64_t cursorTs = 0;
+            int64_t cursorId = 0;
+            if (!parseCursor(query.cursor, cursorTs, cursorId)) {
+                throw std::invalid_argument("Invalid cursor: " + query.cursor);
+            }
+            clauses.push_back("(timestamp < ? OR (timestamp = ? AND id < ?))");
+            args.push_back({false, std::string(), cursorTs});
+            args.push_back({false, std::string(), cursorTs});
+            args.push_back({false, std::string(), cursorId});
+        }
+        std::string where;
+        for (size_t i = 0; i < clauses.size(); ++i) {
+            where += (i == 0 ? " WHERE " : " AND ") + clauses[i];
+        }
+        return where;
+    }
+
+    static void bindArgs(SQLite::Statement& statement, const std::vector<SqlArg>& args) {
+        for (size_t i = 0; i < args.size(); ++i) {
+            int index = static_cast<int>(i) + 1;
+            if (args[i].isText) {
+                statement.bind(index, args[i].text);
+            } else {
+                statement.bind(index, static_cast<int64_t>(args[i].number));
+            }
+        }
+    }
+
+    // 游标格式为 "<timestamp>_<id>"
+    static bool parseCursor(const std::string& cursor, int64_t& timestamp, int64_t& id) {
+        size_t pos = cursor.find('_');
+        if (pos == std::string::npos) return false;
+        try {
+            timestamp = std::stoll(cursor.substr(0, pos));
+            id = std::stoll(cursor.substr(pos + 1));
+        } catch (const std::exception&) {
+            return false;
+        }
+        return true;
+    }
+
+    static json nullableText(const SQLite::Column& column) {
+        return column.isNull() ? json(nullptr) : json(column.getString());
+    }
+
+    // 旧版本以 TEXT 存储秒级 time_t，迁移为毫秒整数
+    void migrateLegacyTimestamp() {
+        bool legacy = false;
+        SQLite::Statement columns(db_, "PRAGMA table_info(alarm_events)");
+        while (columns.executeStep()) {
+            if (columns.getColumn("name").getString() == "timestamp" &&
+                columns.getColumn("type").getString() == "TEXT") {
+                legacy = true;
+            }
+        }
+        if (!legacy) return;
+
+        std::cout << "[DB] Migrating alarm_events.timestamp to epoch milliseconds..." << std::endl;
+        SQLite::Transaction transaction(db_);
+        db_.exec("ALTER TABLE alarm_events RENAME TO alarm_events_legacy");
+        createTable();
+        db_.exec(R"(
+            INSERT INTO alarm_events (id, timestamp, rule_id, resource_name, event_type, details)
+            SELECT id, CAST(timestamp AS INTEGER) * 1000, rule_id, resource_name, event_type, details
+            FROM alarm_events_legacy
+        )");
+        backfillRuleColumns();
+        db_.exec("DROP TABLE alarm_events_legacy");
+        transaction.commit();
+    }
+
+    // 调用方须持有 dbMutex_
+    void bindAndExec(const AlarmEventRecord& record) {
+        insertStmt_->reset();
+        insertStmt_->clearBindings();
+        insertStmt_->bind(1, static_cast<int64_t>(toEpochMillis(record.time)));
+        insertStmt_->bind(2, record.ruleId);
+        insertStmt_->bind(3, record.resourceName);
+        insertStmt_->bind(4, eventTypeToString(record.eventType));
+        insertStmt_->bind(5, record.details);
+        size_t separator = record.ruleId.find(':');
+        if (separator != std::string::npos) {
+            insertStmt_->bind(6, record.ruleId.substr(0, separator));
+            std::string nodeId = record.ruleId.substr(separator + 1);
+            if (nodeId != "*") {
+                insertStmt_->bind(7, nodeId);
+            }
+        }
+        insertStmt_->exec();
+        if (record.members.empty()) return;
+
+        int64_t eventId = db_.getLastInsertRowid();
+        for (const auto& member : record.members) {
+            insertMemberStmt_->reset();
+            insertMemberStmt_->bind(1, static_cast<int64_t>(eventId));
+            insertMemberStmt_->bind(2, member);
+            insertMemberStmt_->exec();
+        }
+    }
+
 public:
     // 构造函数打开数据库并创建表
     explicit AlarmEventRepository(const std::string& dbPath)
@@ -29,41 +300,131 @@ public:
         std::cout << "[DB] Opening database at: " << dbPath << std::endl;
         try {
             std::lock_guard<std::mutex> lock(dbMutex_);
-            db_.exec(R"(
-                CREATE TABLE IF NOT EXISTS alarm_events (
-                    id            INTEGER PRIMARY KEY AUTOINCREMENT,
-                    timestamp     TEXT    NOT NULL,
-                    rule_id       TEXT    NOT NULL,
-                    resource_name TEXT    NOT NULL,
-                    event_type    TEXT    NOT NULL CHECK(event_type IN ('TRIGGERED', 'RECOVERED')),
-                    details       TEXT
-                );
-            )");
+            createTable();
+            createMemberTable();
+            migrateLegacyTimestamp();
+            migrateRuleColumns();
+            migrateStormMembers();
+            db_.exec("CREATE INDEX IF NOT EXISTS idx_alarm_events_rule_time ON alarm_events (rule_id, timestamp)");
+            db_.exec("CREATE INDEX IF NOT EXISTS idx_alarm_events_template_time ON alarm_events (template_id, timestamp)");
+            db_.exec("CREATE INDEX IF NOT EXISTS idx_alarm_events_node_time ON alarm_events (node_id, timestamp)");
+            db_.exec("CREATE INDEX IF NOT EXISTS idx_alarm_events_time ON alarm_events (timestamp)");
+            db_.exec("CREATE INDEX IF NOT EXISTS idx_alarm_event_members_node ON alarm_event_members (node_id, event_id)");
+            insertStmt_.reset(new SQLite::Statement(db_,
+                "INSERT INTO alarm_events (timestamp, rule_id, resource_name, event_type, details, template_id, node_id) "
+                "VALUES (?, ?, ?, ?, ?, ?, ?)"));
+            insertMemberStmt_.reset(new SQLite::Statement(db_,
+                "INSERT OR IGNORE INTO alarm_event_members (event_id, node_id) VALUES (?, ?)"));
         } catch (const std::exception& e) {
             std::cerr << "[DB] Exception on table creation: " << e.what() << std::endl;
             throw;
         }
     }
 
-    // 插入一个新的告警事件
-    void insertEvent(const std::string& ruleId, const std::string& resourceName, AlarmEventType eventType, const std::string& details) {
+    // 插入一个新的告警事件；time 为事件发生时间，默认取当前时间
+    void insertEvent(const std::string& ruleId, const std::string& resourceName, AlarmEventType eventType, const std::string& details,
+                     std::chrono::system_clock::time_point time = std::chrono::system_clock::now()) {
         try {
             std::lock_guard<std::mutex> lock(dbMutex_);
-            
-            // 获取当前时间戳 (ISO 8601 format)
-            auto now = std::chrono::system_clock::now();
-            auto in_time_t = std::chrono::system_clock::to_time_t(now);
-
-            SQLite::Statement query(db_, "INSERT INTO alarm_events (timestamp, rule_id, resource_name, event_type, details) VALUES (?, ?, ?, ?, ?)");
-            query.bind(1, std::to_string(in_time_t));
-            query.bind(2, ruleId);
-            query.bind(3, resourceName);
-            query.bind(4, eventTypeToString(eventType));
-            query.bind(5, details);
-            
-            query.exec();
+            bindAndExec(AlarmEventRecord{ruleId, resourceName, eventType, details, time, {}});
         } catch (const std::exception& e) {
             std::cerr << "[DB] Exception on insert: " << e.what() << std::endl;
         }
     }
-};
\ No newline at end of file
+
+    // 在一个事务内批量插入（含聚合事件的成员），失败时整批回滚；返回是否成功
+    bool insertEvents(const std::vector<AlarmEventRecord>& records) {
+        if (records.empty()) return true;
+        try {
+            std::lock_guard<std::mutex> lock(dbMutex_);
+            SQLite::Transaction transaction(db_);
+            for (const auto& record : records) {
+                bindAndExec(record);
+            }
+            transaction.commit();
+            return true;
+        } catch (const std::exception& e) {
+            std::cerr << "[DB] Exception on batch insert of " << records.size() << " events: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    // 按条件分页查询事件，返回 {"events": [...], "next_cursor": ...}；没有下一页时 next_cursor 为null
+    // 每个事件带 members 数组，聚合事件为其成员节点，其他事件为空
+    json queryEvents(const AlarmEventQuery& query) {
+        int limit = std::max(1, std::min(query.limit, kMaxAlarmEventQueryLimit));
+        std::vector<SqlArg> args;
+        std::string sql = "SELECT id, timestamp, rule_id, template_id, node_id, resource_name, event_type, details, "
+                          "(SELECT json_group_array(node_id) FROM alarm_event_members WHERE event_id = alarm_events.id) "
+                          "FROM alarm_events" + buildWhere(query, args, true) +
+                          " ORDER BY timestamp DESC, id DESC LIMIT ?";
+        args.push_back({false, std::string(), limit + 1}); // 多取一条判断是否还有下一页
+
+        std::lock_guard<std::mutex> lock(dbMutex_);
+        SQLite::Statement statement(db_, sql);
+        bindArgs(statement, args);
+        json events = json::array();
+        json nextCursor = nullptr;
+        while (statement.executeStep()) {
+            if (static_cast<int>(events.size()) == limit) {
+                const json& last = events.back();
+                nextCursor = std::to_string(last["timestamp"].get<int64_t>()) + "_" +
+                             std::to_string(last["id"].get<int64_t>());
+                break;
+            }
+            events.push_back({
+                {"id", statement.getColumn(0).getInt64()},
+                {"timestamp", statement.getColumn(1).getInt64()},
+                {"rule_id", statement.getColumn(2).getString()},
+                {"template_id", nullableText(statement.getColumn(3))},
+                {"node_id", nullableText(statement.getColumn(4))},
+                {"resource_name", statement.getColumn(5).getString()},
+                {"event_type", statement.getColumn(6).getString()},
+                {"details", nullableText(statement.getColumn(7))},
+                {"members", json::parse(statement.getColumn(8).getString())}
+            });
+        }
+        return json{{"events", events}, {"next_cursor", nextCursor}};
+    }
+
+    // 按规则/模板/节点分组统计事件数，在数据库内完成聚合；groupBy 取 "rule"、"template" 或 "node"
+    // 按节点分组时聚合事件按成员展开，计入每个成员节点
+    json countEvents(const AlarmEventQuery& query, const std::string& groupBy) {
+        std::string column;
+        if (groupBy == "rule") column = "rule_id";
+        else if (groupBy == "template") column = "template_id";
+        else if (groupBy == "node") column = "node_id";
+        else throw std::invalid_argument("Invalid group_by: " + groupBy);
+
+        int limit = std::max(1, std::min(query.limit, kMaxAlarmEventQueryLimit));
+        bool expand = groupBy == "node";
+        std::string source = expand
+            ? "(SELECT e.id, e.timestamp, e.rule_id, e.template_id, e.event_type, "
+              "COALESCE(m.node_id, e.node_id) AS node_id "
+              "FROM alarm_events e LEFT JOIN alarm_event_members m ON m.event_id = e.id)"
+            : "alarm_events";
+        std::vector<SqlArg> args;
+        std::string sql = "SELECT " + column + ", COUNT(*), "
+                          "SUM(event_type = 'TRIGGERED'), SUM(event_type = 'RECOVERED'), "
+                          "MIN(timestamp), MAX(timestamp) FROM " + source +
+                          buildWhere(query, args, false, expand) +
+                          " GROUP BY " + column + " ORDER BY COUNT(*) DESC LIMIT ?";
+        args.push_back({false, std::string(), limit});
+
+        std::lock_guard<std::mutex> lock(dbMutex_);
+        SQLite::Statement statement(db_, sql);
+        bindArgs(statement, args);
+        json groups = json::array();
+        while (statement.executeStep()) {
+            groups.push_back({
+                {column, nullableText(statement.getColumn(0))},
+                {"total", statement.getColumn(1).getInt64()},
+                {"triggered", statement.getColumn(2).getInt64()},
+                {"recovered", statement.getColumn(3).getInt64()},
+                {"first_timestamp", statement.getColumn(4).getInt64()},
+                {"last_timestamp", statement.getColumn(5).getInt64()}
+            });
+        }
+        return json{{"group_by", groupBy}, {"groups", groups}};
+    }
+};
@@ -1,88 +1,591 @@
 // AlarmManager.h
 #pragma once
 #include "AlarmRule.h"
+#include "AlarmRuleTemplate.h"
+#include "ConditionProgram.h"
+#include "MetricCache.h"
+#include "TemplateEvaluator.h"
+#include "ActionDispatcher.h"
+#include "StormAggregator.h"
+#include "SweepPool.h"
+#include "ExpressionProgram.h"
+#include "GreaterThanCondition.h"
 #include <map>
+#include <algorithm>
 #include <string>
 #include <set>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <memory>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <iostream>
 
-// 告警管理器，负责检查已实例化的规则
+// 告警管理器，负责检查告警模板与单独添加的规则
+//
+// 模板直接按列评估（见 TemplateEvaluator），只对已纳管的节点生效，
+// 内存随模板数而非 模板 × 节点 增长；只有写入版本变化的分片才会被重新扫描。
+// 模板迁移先经过风暴聚合（见 StormAggregator），同一模板短时间内的大量迁移合并为一条通知。
+// 单独添加的规则按节点建立索引，只有刚上报数据的节点（脏节点）才会被重新评估；
+// 不绑定节点的规则由低频的兜底检查覆盖。
+//
+// 规则集是不可变的、带版本号的快照，增删规则时复制出新版本并原子替换，
+// 检查线程每轮只原子读取一次快照指针，无需复制规则，也无需加锁。
+// 每条规则的触发状态存放在评估线程独占的紧凑数组中，按规则的状态槽位索引。
+// 规则的条件在发布时编译为 ConditionProgram，评估时不再经过条件树的虚函数调用；
+// 窗口类的有状态条件除外，其状态同样存放在该数组中。
+//
+// 每轮检查按节点哈希分片（与 MetricCache 的分片一致）拆成独立任务，由评估线程池并行执行：
+// 每条规则、每个模板分片状态只属于一个分片，评估期间无需加锁；各分片产生的迁移
+// 按分片顺序合并为本轮的迁移列表，再由检查线程统一执行动作与风暴聚合。
 class AlarmManager {
 private:
-    std::map<std::string, AlarmRule> rules_;
-    mutable std::mutex rulesMutex_;
+    // 规则集中的一项；slot 在规则存续期间不变，serial 区分复用同一槽位的不同规则
+    struct RuleEntry {
+        std::shared_ptr<const AlarmRule> rule;
+        std::shared_ptr<const ConditionProgram> program;
+        uint32_t slot;
+        uint64_t serial;
+        bool stateful;   // 条件带窗口等状态，不走编译后的程序
+    };
+
+    struct RuleSet {
+        uint64_t version = 0;
+        std::vector<RuleEntry> entries;
+        std::unordered_map<std::string, uint32_t> byId;                 // ruleId -> entries下标
+        std::unordered_map<std::string, std::vector<uint32_t>> byNode;  // nodeId -> entries下标
+        std::vector<std::vector<uint32_t>> byShard;                     // 评估分片 -> entries下标
+        uint32_t slotCount = 0;                                         // 状态槽位上界
+        std::vector<CompiledTemplate> templates;
+    };
+
+    // 规则状态，只由规则所在分片的评估线程访问
+    struct RuleState {
+        uint64_t serial = 0;
+        bool triggered = false;
+        std::unique_ptr<ConditionState> conditionState;
+    };
+
+    // 一次规则级的状态迁移，指向规则集快照，持有快照期间有效
+    struct RuleTransition {
+        const RuleEntry* entry;
+        bool triggered;
+    };
+
+    // 单个评估分片在一轮检查中的输入与输出，仅由处理该分片的线程写入
+    struct SweepShard {
+        std::vector<const std::vector<uint32_t>*> dirtyRules; // 本分片脏节点上的规则
+        std::vector<RuleTransition> rules;
+        std::vector<TemplateTransition> templates;
+    };
+
+    std::shared_ptr<MetricCache> cache_;
+    std::shared_ptr<ActionDispatcher> dispatcher_;
+
+    std::shared_ptr<const RuleSet> ruleSet_ = std::make_shared<RuleSet>();
+    std::mutex writerMutex_;             // 串行化规则集的写入者
+    std::vector<uint32_t> freeSlots_;    // 受 writerMutex_ 保护
+    uint32_t nextSlot_ = 0;
+    std::vector<uint32_t> freeTemplateSlots_;
+    uint32_t nextTemplateSlot_ = 0;
+    uint64_t nextSerial_ = 1;
+
+    const size_t shardCount_;            // 评估分片数
+    std::vector<RuleState> states_;      // 按槽位；每个槽位只由其规则所在分片的评估线程访问
+    TemplateEvaluator evaluator_;        // 按分片存放状态，同上
+    std::vector<SweepShard> sweepShards_;
+    SweepPool pool_;
+    StormAggregator aggregator_;         // 仅检查线程访问
+    std::vector<AlarmNotification> notifications_;
+
+    std::set<std::string> dirtyNodes_;
+    std::vector<std::pair<MetricCache::NodeIndex, bool>> pendingEnrollment_;
+    bool templatesChanged_ = false;
+    std::mutex dirtyMutex_;
+    std::condition_variable dirtyCv_;
+
+    std::chrono::seconds fullSweepInterval_{30};
     std::atomic<bool> stopRequested_{false};
     std::thread workerThread_;
 
-    void checkAlarms() {
-        // 复制一份规则列表进行检查，避免长时间锁定
-        std::map<std::string, AlarmRule> rulesToCheck;
-        {
-            std::lock_guard<std::mutex> lock(rulesMutex_);
-            rulesToCheck = rules_;
+    std::shared_ptr<const RuleSet> snapshot() const {
+        return std::atomic_load(&ruleSet_);
+    }
+
+    // 设置了分发器时动作异步执行，否则在检查线程上直接执行
+    void runActions(const std::vector<std::shared_ptr<IAlarmAction>>& actions,
+                    const std::string& ruleId, const std::string& resourceName,
+                    std::vector<std::string> members = {}) {
+        if (actions.empty()) return;
+        AlarmActionEvent event{ruleId, resourceName, std::chrono::system_clock::now(), std::move(members)};
+        if (!dispatcher_) {
+            for (const auto& action : actions) {
+                if (event.members.empty()) {
+                    action->execute(ruleId, resourceName);
+                } else {
+                    action->executeBatch({event}); // 聚合通知需要携带成员列表
+                }
+            }
+            return;
+        }
+        for (const auto& action : actions) {
+            dispatcher_->enqueue(action, event);
+        }
+    }
+
+    size_t shardOfNode(const std::string& nodeId) const {
+        return cache_ ? cache_->shardOfNode(nodeId) : std::hash<std::string>()(nodeId) % shardCount_;
+    }
+
+    size_t shardOfRule(const AlarmRule& rule) const {
+        if (rule.nodeId.empty()) {
+            return std::hash<std::string>()(rule.ruleId) % shardCount_; // 不绑定节点的规则按ID分散
+        }
+        return shardOfNode(rule.nodeId);
+    }
+
+    // 在评估线程上执行：只读写该规则自己的状态槽位，迁移追加到所在分片的输出
+    // newSample 为false时不向有状态条件追加样本，只按时间淘汰后重新判断
+    void evaluateRule(const RuleEntry& entry, bool newSample, std::vector<RuleTransition>& out) {
+        RuleState& state = states_[entry.slot];
+        const AlarmRule& rule = *entry.rule;
+        if (state.serial != entry.serial) {
+            state.serial = entry.serial;
+            state.triggered = rule.isCurrentlyTriggered;
+            state.conditionState = entry.stateful ? rule.condition->createState() : nullptr;
+        }
+
+        double currentValue = rule.resource->getValue();
+        bool triggered;
+        if (entry.stateful) {
+            auto now = std::chrono::steady_clock::now();
+            if (newSample) {
+                rule.condition->addSample(*state.conditionState, currentValue, now);
+            }
+            triggered = rule.condition->isStateTriggered(*state.conditionState, now);
+        } else {
+            triggered = entry.program->evaluate(currentValue);
+        }
+
+        if (triggered != state.triggered) {
+            state.triggered = triggered;
+            out.push_back({&entry, triggered});
+        }
+    }
+
+    // 一轮检查：各分片并行评估规则与模板，再按分片顺序合并迁移并执行动作
+    // fullSweep 为true时为兜底检查，覆盖所有规则（绑定节点的规则只在节点有新数据时才向窗口追加样本，
+    // 不绑定节点的规则按检查周期采样），否则只检查脏节点上的规则；
+    // forceTemplates 为true时忽略分片版本，扫描所有分片上的模板
+    void sweep(const RuleSet& rules, const std::set<std::string>& dirty, bool fullSweep, bool forceTemplates) {
+        if (states_.size() < rules.slotCount) {
+            states_.resize(rules.slotCount); // 须在并行评估之前完成
+        }
+        for (auto& shard : sweepShards_) {
+            shard.dirtyRules.clear();
+            shard.rules.clear();
+            shard.templates.clear();
+        }
+        if (!fullSweep) {
+            for (const auto& nodeId : dirty) {
+                auto nodeIt = rules.byNode.find(nodeId);
+                if (nodeIt != rules.byNode.end()) {
+                    sweepShards_[shardOfNode(nodeId)].dirtyRules.push_back(&nodeIt->second);
+                }
+            }
+        }
+        const bool sweepTemplates = !rules.templates.empty() && cache_;
+        const auto sweepStart = std::chrono::steady_clock::now();
+        if (!sweepTemplates) {
+            evaluator_.clearDue();
         }
 
-        for (auto& pair : rulesToCheck) {
-            AlarmRule& rule = pair.second;
-            double currentValue = rule.resource->getValue();
-            bool triggered = rule.condition->isTriggered(currentValue);
+        pool_.run(shardCount_, [&](size_t shardNo) {
+            SweepShard& shard = sweepShards_[shardNo];
+            if (fullSweep && shardNo < rules.byShard.size()) {
+                for (uint32_t index : rules.byShard[shardNo]) {
+                    const RuleEntry& entry = rules.entries[index];
+                    const std::string& nodeId = entry.rule->nodeId;
+                    evaluateRule(entry, nodeId.empty() || dirty.count(nodeId) > 0, shard.rules);
+                }
+            } else {
+                for (const auto* indices : shard.dirtyRules) {
+                    for (uint32_t index : *indices) {
+                        evaluateRule(rules.entries[index], true, shard.rules);
+                    }
+                }
+            }
+            if (sweepTemplates && (forceTemplates || evaluator_.isShardDirty(shardNo, sweepStart))) {
+                evaluator_.sweepShard(shardNo, rules.templates, shard.templates);
+            }
+        });
 
-            if (triggered && !rule.isCurrentlyTriggered) {
-                // 状态从 Normal -> Triggered
-                for (const auto& action : rule.actions) {
-                    action->execute(rule.ruleId, rule.resource->getName());
+        const auto now = std::chrono::steady_clock::now();
+        for (const auto& shard : sweepShards_) {
+            for (const auto& transition : shard.rules) {
+                const AlarmRule& rule = *transition.entry->rule;
+                if (transition.triggered) {
+                    // 状态从 Normal -> Triggered
+                    runActions(rule.actions, rule.ruleId, rule.resource->getName());
+                } else {
+                    // 状态从 Triggered -> Normal
+                    std::cout << "[INFO] Alarm '" << rule.ruleId << "' has recovered." << std::endl;
+                    runActions(rule.recoveryActions, rule.ruleId, rule.resource->getName()); // 执行恢复动作
                 }
-                updateRuleState(rule.ruleId, true); // 更新主列表中的状态
-            } else if (!triggered && rule.isCurrentlyTriggered) {
-                // 状态从 Triggered -> Normal
-                std::cout << "[INFO] Alarm '" << rule.ruleId << "' has recovered." << std::endl;
-                    for (const auto& action : rule.recoveryActions) { // 执行恢复动作
-                    action->execute(rule.ruleId, rule.resource->getName());
+            }
+            for (const auto& transition : shard.templates) {
+                if (aggregator_.enabled()) {
+                    aggregator_.add(transition.tpl->tpl, transition.nodeId, transition.triggered, now);
+                } else {
+                    dispatchNotification({transition.tpl->tpl, transition.triggered, {transition.nodeId}});
                 }
-                updateRuleState(rule.ruleId, false);
             }
         }
     }
-    
-    void updateRuleState(const std::string& ruleId, bool isTriggered) {
-        std::lock_guard<std::mutex> lock(rulesMutex_);
-        auto it = rules_.find(ruleId);
-        if (it != rules_.end()) {
-            it->second.isCurrentlyTriggered = isTriggered;
+
+    void flushNotifications(bool force) {
+        notifications_.clear();
+        aggregator_.flush(std::chrono::steady_clock::now(), force, notifications_);
+        for (const auto& notification : notifications_) {
+            dispatchNotification(notification);
+        }
+    }
+
+    static std::string describeSubject(const AlarmRuleTemplate& tpl) {
+        return tpl.expression.empty() ? "Metric '" + tpl.metricName + "'" : "Expression '" + tpl.expression + "'";
+    }
+
+    // 单个成员沿用与单条规则一致的规则ID和资源名；
+    // 聚合通知的规则ID为 "<templateId>:*"，完整成员列表随事件传给动作
+    void dispatchNotification(const AlarmNotification& notification) {
+        const AlarmRuleTemplate& tpl = *notification.tpl;
+        const auto& members = notification.members;
+        std::string ruleId;
+        std::string resourceName;
+        if (members.size() == 1) {
+            ruleId = tpl.templateId + ":" + members[0];
+            resourceName = describeSubject(tpl) + " on node '" + members[0] + "'";
+        } else {
+            ruleId = tpl.templateId + ":*";
+            resourceName = describeSubject(tpl) + " on " + std::to_string(members.size()) + " nodes (";
+            const size_t shown = std::min<size_t>(members.size(), 5);
+            for (size_t i = 0; i < shown; ++i) {
+                resourceName += (i ? ", '" : "'") + members[i] + "'";
+            }
+            resourceName += members.size() > shown ? ", ...)" : ")";
+        }
+        std::vector<std::string> groupMembers = members.size() > 1 ? members : std::vector<std::string>();
+        if (notification.triggered) {
+            runActions(tpl.actions, ruleId, resourceName, std::move(groupMembers));
+        } else {
+            std::cout << "[INFO] Alarm '" << ruleId << "' has recovered";
+            if (members.size() > 1) {
+                std::cout << " on " << members.size() << " nodes";
+            }
+            std::cout << "." << std::endl;
+            runActions(tpl.recoveryActions, ruleId, resourceName, std::move(groupMembers));
         }
     }
 
+    uint32_t allocateSlot(std::vector<uint32_t>& freeSlots, uint32_t& nextSlot) {
+        if (!freeSlots.empty()) {
+            uint32_t slot = freeSlots.back();
+            freeSlots.pop_back();
+            return slot;
+        }
+        return nextSlot++;
+    }
+
+    // 复制当前快照（规则与模板均只复制指针）。调用方须持有 writerMutex_
+    std::shared_ptr<RuleSet> cloneLocked() const {
+        std::shared_ptr<const RuleSet> current = snapshot();
+        auto next = std::make_shared<RuleSet>();
+        next->version = current->version + 1;
+        next->entries = current->entries;
+        next->templates = current->templates;
+        return next;
+    }
+
+    // 重建索引并原子发布新版本。调用方须持有 writerMutex_
+    void publishLocked(std::shared_ptr<RuleSet> next) {
+        next->byShard.resize(shardCount_);
+        next->slotCount = nextSlot_;
+        for (uint32_t i = 0; i < next->entries.size(); ++i) {
+            const AlarmRule& rule = *next->entries[i].rule;
+            next->byId.emplace(rule.ruleId, i);
+            if (!rule.nodeId.empty()) {
+                next->byNode[rule.nodeId].push_back(i);
+            }
+            next->byShard[shardOfRule(rule)].push_back(i);
+        }
+        std::shared_ptr<const RuleSet> published = std::move(next);
+        std::atomic_store(&ruleSet_, published);
+    }
+
+    // 应用一批规则增删。调用方须持有 writerMutex_
+    void applyRuleChangesLocked(RuleSet& next, const std::vector<AlarmRule>& toAdd,
+                                const std::set<std::string>& toRemove) {
+        std::set<std::string> replaced;
+        for (const auto& rule : toAdd) {
+            replaced.insert(rule.ruleId);
+        }
+
+        std::vector<RuleEntry> kept;
+        kept.reserve(next.entries.size() + toAdd.size());
+        for (auto& entry : next.entries) {
+            const std::string& ruleId = entry.rule->ruleId;
+            if (toRemove.count(ruleId) || replaced.count(ruleId)) {
+                freeSlots_.push_back(entry.slot);
+                continue;
+            }
+            kept.push_back(std::move(entry));
+        }
+        // 共享同一条件对象的规则共享编译结果
+        std::map<const IAlarmCondition*, std::shared_ptr<const ConditionProgram>> compiled;
+        for (const auto& rule : toAdd) {
+            RuleEntry entry;
+            entry.rule = std::make_shared<const AlarmRule>(rule);
+            auto& program = compiled[rule.condition.get()];
+            if (!program) {
+                program = std::make_shared<const ConditionProgram>(ConditionProgram::compile(rule.condition));
+            }
+            entry.program = program;
+            entry.slot = allocateSlot(freeSlots_, nextSlot_);
+            entry.serial = nextSerial_++;
+            entry.stateful = rule.condition && rule.condition->createState() != nullptr;
+            kept.push_back(std::move(entry));
+        }
+        next.entries.swap(kept);
+    }
+
     void run() {
+        auto nextFullSweep = std::chrono::steady_clock::now() + fullSweepInterval_;
         while (!stopRequested_) {
-            checkAlarms();
-            std::this_thread::sleep_for(std::chrono::seconds(5));
+            std::set<std::string> dirty;
+            std::vector<std::pair<MetricCache::NodeIndex, bool>> enrollment;
+            bool templatesChanged;
+            auto wakeAt = nextFullSweep;
+            StormAggregator::TimePoint groupDeadline;
+            if (aggregator_.nextDeadline(groupDeadline) && groupDeadline < wakeAt) {
+                wakeAt = groupDeadline;
+            }
+            // 有状态模板的窗口样本到期时无需等待新上报
+            wakeAt = std::min(wakeAt, evaluator_.nextDue());
+            {
+                std::unique_lock<std::mutex> lock(dirtyMutex_);
+                dirtyCv_.wait_until(lock, wakeAt, [this] {
+                    return stopRequested_ || !dirtyNodes_.empty() || !pendingEnrollment_.empty() ||
+                           templatesChanged_;
+                });
+                dirty.swap(dirtyNodes_);
+                enrollment.swap(pendingEnrollment_);
+                templatesChanged = templatesChanged_;
+                templatesChanged_ = false;
+            }
+            if (stopRequested_) break;
+
+            for (const auto& op : enrollment) {
+                evaluator_.setEnrolled(op.first, op.second);
+            }
+
+            std::shared_ptr<const RuleSet> rules = snapshot();
+            if (std::chrono::steady_clock::now() >= nextFullSweep) {
+                sweep(*rules, dirty, true, true);
+                nextFullSweep = std::chrono::steady_clock::now() + fullSweepInterval_;
+            } else {
+                sweep(*rules, dirty, false, templatesChanged);
+            }
+            flushNotifications(false);
         }
+        flushNotifications(true); // 停止前发出尚在窗口内的通知
     }
 
 public:
+    explicit AlarmManager(std::shared_ptr<MetricCache> cache = nullptr)
+        : cache_(std::move(cache)), shardCount_(cache_ ? cache_->getShardCount() : 1), evaluator_(cache_),
+          sweepShards_(shardCount_) {}
+
     void addRule(const AlarmRule& rule) {
-        std::lock_guard<std::mutex> lock(rulesMutex_);
-        rules_[rule.ruleId] = rule;
+        applyChanges({rule}, {});
     }
 
     void removeRule(const std::string& ruleId) {
-        std::lock_guard<std::mutex> lock(rulesMutex_);
-        rules_.erase(ruleId);
+        applyChanges({}, {ruleId});
+    }
+
+    // 批量增删规则，只发布一个新版本；同ID的规则会被替换
+    void applyChanges(const std::vector<AlarmRule>& toAdd, const std::set<std::string>& toRemove) {
+        if (toAdd.empty() && toRemove.empty()) return;
+        {
+            std::lock_guard<std::mutex> lock(writerMutex_);
+            auto next = cloneLocked();
+            applyRuleChangesLocked(*next, toAdd, toRemove);
+            publishLocked(std::move(next));
+        }
+        // 新规则立即参与下一次评估
+        for (const auto& rule : toAdd) {
+            if (!rule.nodeId.empty()) {
+                markNodeDirty(rule.nodeId);
+            }
+        }
+    }
+
+    // 添加或替换告警模板，对所有已纳管节点生效（需要构造时传入MetricCache）
+    void addTemplate(const AlarmRuleTemplate& tpl) {
+        if (!cache_) {
+            std::cerr << "[AlarmManager] No metric cache, template '" << tpl.templateId << "' ignored." << std::endl;
+            return;
+        }
+        // 表达式在发布前编译，出错时不影响当前规则集
+        AlarmRuleTemplate effective = tpl;
+        std::shared_ptr<const ExpressionProgram> expression;
+        if (!tpl.expression.empty()) {
+            try {
+                expression = std::make_shared<const ExpressionProgram>(ExpressionProgram::compile(tpl.expression, *cache_));
+            } catch (const std::invalid_argument& e) {
+                std::cerr << "[AlarmManager] Template '" << tpl.templateId << "' ignored: " << e.what() << std::endl;
+                return;
+            }
+            if (!effective.condition) {
+                if (expression->getType() != ExpressionProgram::Type::BOOLEAN) {
+                    std::cerr << "[AlarmManager] Template '" << tpl.templateId
+                              << "' ignored: numeric expression requires a condition." << std::endl;
+                    return;
+                }
+                effective.condition = std::make_shared<GreaterThanCondition>(0.5); // 布尔值为 1.0/0.0
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(writerMutex_);
+            auto next = cloneLocked();
+            for (auto it = next->templates.begin(); it != next->templates.end(); ++it) {
+                if (it->tpl->templateId == tpl.templateId) {
+                    freeTemplateSlots_.push_back(it->slot);
+                    next->templates.erase(it);
+                    break;
+                }
+            }
+            CompiledTemplate compiled;
+            compiled.tpl = std::make_shared<const AlarmRuleTemplate>(effective);
+            compiled.program = std::make_shared<const ConditionProgram>(ConditionProgram::compile(effective.condition));
+            compiled.metric = expression ? 0 : cache_->internMetric(tpl.metricName);
+            compiled.expression = expression;
+            compiled.slot = allocateSlot(freeTemplateSlots_, nextTemplateSlot_);
+            compiled.serial = nextSerial_++;
+            compiled.stateful = effective.condition && effective.condition->createState() != nullptr;
+            next->templates.push_back(std::move(compiled));
+            publishLocked(std::move(next));
+        }
+        notifyTemplatesChanged();
+    }
+
+    void removeTemplate(const std::string& templateId) {
+        bool removed = false;
+        {
+            std::lock_guard<std::mutex> lock(writerMutex_);
+            auto next = cloneLocked();
+            for (auto it = next->templates.begin(); it != next->templates.end(); ++it) {
+                if (it->tpl->templateId == templateId) {
+                    freeTemplateSlots_.push_back(it->slot);
+                    next->templates.erase(it);
+                    publishLocked(std::move(next));
+                    removed = true;
+                    break;
+                }
+            }
+        }
+        // 与 addTemplate 相同，立即按新的模板集合评估，不等下一次全量扫描
+        if (removed) {
+            notifyTemplatesChanged();
+        }
+    }
+
+    // 纳管节点：模板开始对该节点生效
+    void enrollNodes(const std::vector<MetricCache::NodeIndex>& nodes) {
+        updateEnrollment(nodes, true);
+    }
+
+    // 移出节点：清除其模板告警状态（不产生恢复事件）
+    void retireNodes(const std::vector<MetricCache::NodeIndex>& nodes) {
+        updateEnrollment(nodes, false);
+    }
+
+    void updateEnrollment(const std::vector<MetricCache::NodeIndex>& nodes, bool enrolled) {
+        if (nodes.empty()) return;
+        {
+            std::lock_guard<std::mutex> lock(dirtyMutex_);
+            for (auto node : nodes) {
+                pendingEnrollment_.emplace_back(node, enrolled);
+            }
+        }
+        dirtyCv_.notify_one();
     }
 
     std::set<std::string> getManagedRuleIds() const {
-        std::lock_guard<std::mutex> lock(rulesMutex_);
+        std::shared_ptr<const RuleSet> rules = snapshot();
         std::set<std::string> ids;
-        for(const auto& pair : rules_) {
+        for (const auto& pair : rules->byId) {
             ids.insert(pair.first);
         }
         return ids;
     }
 
+    // 当前规则集的版本号、规则数与模板数
+    uint64_t getRuleSetVersion() const {
+        return snapshot()->version;
+    }
+
+    size_t getRuleCount() const {
+        return snapshot()->entries.size();
+    }
+
+    size_t getTemplateCount() const {
+        return snapshot()->templates.size();
+    }
+
+    // 由MetricCache的更新回调调用：标记节点有新数据，唤醒检查线程
+    void markNodeDirty(const std::string& nodeId) {
+        {
+            std::lock_guard<std::mutex> lock(dirtyMutex_);
+            dirtyNodes_.insert(nodeId);
+        }
+        dirtyCv_.notify_one();
+    }
+
+    void notifyTemplatesChanged() {
+        {
+            std::lock_guard<std::mutex> lock(dirtyMutex_);
+            templatesChanged_ = true;
+        }
+        dirtyCv_.notify_one();
+    }
+
+    // 设置动作分发器，须在 start 之前调用
+    void setActionDispatcher(std::shared_ptr<ActionDispatcher> dispatcher) {
+        dispatcher_ = std::move(dispatcher);
+    }
+
+    // 设置告警风暴聚合：同一模板在 window 内同方向迁移的节点数达到 minGroupSize 时合并为一条通知；
+    // window 为0时关闭聚合。须在 start 之前调用
+    void setStormAggregation(std::chrono::milliseconds window, size_t minGroupSize = 3) {
+        aggregator_.configure(window, minGroupSize);
+    }
+
+    // 设置参与评估的线程数（含检查线程本身），1表示在检查线程上顺序评估。须在 start 之前调用
+    void setSweepWorkers(size_t workers) {
+        pool_.resize(workers > 1 ? workers - 1 : 0);
+    }
+
+    // 设置兜底全量检查的周期
+    void setFullSweepInterval(std::chrono::seconds interval) {
+        fullSweepInterval_ = interval;
+    }
+
     void start() {
         if (workerThread_.joinable()) return;
         stopRequested_ = false;
@@ -91,10 +594,14 @@ public:
     }
 
     void stop() {
-        stopRequested_ = true;
+        {
+            std::lock_guard<std::mutex> lock(dirtyMutex_);
+            stopRequested_ = true;
+        }
+        dirtyCv_.notify_all();
         if (workerThread_.joinable()) {
             workerThread_.join();
         }
         std::cout << "[AlarmManager] Stopped." << std::endl;
     }
-};
\ No newline at end of file
+};
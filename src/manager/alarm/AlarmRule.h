@@ -10,6 +10,7 @@
 // 代表一个具体的、已实例化的告警规则
 struct AlarmRule {
     std::string ruleId; // 规则的唯一实例ID, e.g., "tpl-high-cpu:node-01"
+    std::string nodeId; // 规则所属节点，为空表示不绑定节点（由周期兜底检查）
     std::shared_ptr<IResource> resource;
     std::shared_ptr<IAlarmCondition> condition;
     std::vector<std::shared_ptr<IAlarmAction>> actions;
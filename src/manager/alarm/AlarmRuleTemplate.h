@@ -10,6 +10,9 @@
 struct AlarmRuleTemplate {
     std::string templateId;       // 模板的唯一ID, e.g., "tpl-high-cpu"
     std::string metricName;       // 要监控的指标名称, e.g., "cpu_usage_percent"
+    // 多指标表达式（见 ExpressionProgram），非空时取代 metricName 作为被监控的值；
+    // 布尔表达式可不设 condition，表达式为真即触发；读到缺失指标时结果为NaN，不触发
+    std::string expression;
     std::shared_ptr<IAlarmCondition> condition;
     std::vector<std::shared_ptr<IAlarmAction>> actions;
     std::vector<std::shared_ptr<IAlarmAction>> recoveryActions;
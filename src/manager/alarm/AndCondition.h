@@ -1,6 +1,7 @@
 // AndCondition.h
 #pragma once
 #include "IAlarmCondition.h"
+#include "ConditionProgram.h"
 #include <vector>
 #include <memory>
 #include <sstream>
@@ -22,6 +23,19 @@ public:
         return true; // 所有都为true
     }
 
+    bool toIntervals(IntervalSet& out) const override {
+        IntervalSet result = IntervalSet::all();
+        for (const auto& cond : conditions_) {
+            IntervalSet child;
+            if (!cond->toIntervals(child)) {
+                return false;
+            }
+            result = result.intersect(child);
+        }
+        out = result;
+        return true;
+    }
+
     std::string getDescription() const override {
         std::stringstream ss;
         ss << "(";
@@ -0,0 +1,237 @@
+// ConditionProgram.h
+#pragma once
+#include "IAlarmCondition.h"
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+
+// 实数轴上互不相交、按下界排序的区间并集，外加NaN是否属于该集合
+// 任意由 >、<、AND、OR、NOT 组成的单值条件树都等价于这样一个集合。
+class IntervalSet {
+public:
+    struct Interval {
+        double lo;
+        double hi;
+        bool loClosed;
+        bool hiClosed;
+    };
+
+    static IntervalSet greaterThan(double threshold) {
+        IntervalSet s;
+        s.intervals_.push_back({threshold, std::numeric_limits<double>::infinity(), false, true});
+        return s;
+    }
+
+    static IntervalSet lessThan(double threshold) {
+        IntervalSet s;
+        s.intervals_.push_back({-std::numeric_limits<double>::infinity(), threshold, true, false});
+        return s;
+    }
+
+    // 空集作为 OR 的单位元
+    static IntervalSet empty() {
+        return IntervalSet();
+    }
+
+    // 全集作为 AND 的单位元
+    static IntervalSet all() {
+        IntervalSet s;
+        s.intervals_.push_back({-std::numeric_limits<double>::infinity(),
+                                std::numeric_limits<double>::infinity(), true, true});
+        s.containsNaN_ = true;
+        return s;
+    }
+
+    IntervalSet complement() const {
+        IntervalSet s;
+        s.containsNaN_ = !containsNaN_;
+        Interval gap{-std::numeric_limits<double>::infinity(), 0.0, true, false};
+        for (const auto& iv : intervals_) {
+            gap.hi = iv.lo;
+            gap.hiClosed = !iv.loClosed;
+            s.pushIfNonEmpty(gap);
+            gap.lo = iv.hi;
+            gap.loClosed = !iv.hiClosed;
+        }
+        gap.hi = std::numeric_limits<double>::infinity();
+        gap.hiClosed = true;
+        s.pushIfNonEmpty(gap);
+        return s;
+    }
+
+    IntervalSet intersect(const IntervalSet& other) const {
+        IntervalSet s;
+        s.containsNaN_ = containsNaN_ && other.containsNaN_;
+        for (const auto& a : intervals_) {
+            for (const auto& b : other.intervals_) {
+                Interval iv;
+                if (a.lo > b.lo) { iv.lo = a.lo; iv.loClosed = a.loClosed; }
+                else if (b.lo > a.lo) { iv.lo = b.lo; iv.loClosed = b.loClosed; }
+                else { iv.lo = a.lo; iv.loClosed = a.loClosed && b.loClosed; }
+                if (a.hi < b.hi) { iv.hi = a.hi; iv.hiClosed = a.hiClosed; }
+                else if (b.hi < a.hi) { iv.hi = b.hi; iv.hiClosed = b.hiClosed; }
+                else { iv.hi = a.hi; iv.hiClosed = a.hiClosed && b.hiClosed; }
+                s.pushIfNonEmpty(iv);
+            }
+        }
+        s.normalize();
+        return s;
+    }
+
+    IntervalSet unite(const IntervalSet& other) const {
+        IntervalSet s;
+        s.containsNaN_ = containsNaN_ || other.containsNaN_;
+        s.intervals_ = intervals_;
+        s.intervals_.insert(s.intervals_.end(), other.intervals_.begin(), other.intervals_.end());
+        s.normalize();
+        return s;
+    }
+
+    const std::vector<Interval>& intervals() const { return intervals_; }
+    bool containsNaN() const { return containsNaN_; }
+
+private:
+    std::vector<Interval> intervals_;
+    bool containsNaN_ = false;
+
+    void pushIfNonEmpty(const Interval& iv) {
+        if (iv.lo < iv.hi || (iv.lo == iv.hi && iv.loClosed && iv.hiClosed)) {
+            intervals_.push_back(iv);
+        }
+    }
+
+    // 排序并合并重叠或相接的区间
+    void normalize() {
+        std::sort(intervals_.begin(), intervals_.end(), [](const Interval& a, const Interval& b) {
+            if (a.lo != b.lo) return a.lo < b.lo;
+            return a.loClosed && !b.loClosed;
+        });
+        std::vector<Interval> merged;
+        for (const auto& iv : intervals_) {
+            if (!merged.empty()) {
+                Interval& last = merged.back();
+                bool touches = iv.lo < last.hi || (iv.lo == last.hi && (last.hiClosed || iv.loClosed));
+                if (touches) {
+                    if (iv.hi > last.hi) { last.hi = iv.hi; last.hiClosed = iv.hiClosed; }
+                    else if (iv.hi == last.hi) { last.hiClosed = last.hiClosed || iv.hiClosed; }
+                    continue;
+                }
+            }
+            merged.push_back(iv);
+        }
+        intervals_.swap(merged);
+    }
+};
+
+// 编译后的条件程序
+// 条件树被展平为一组阈值区间，求值时逐区间做无分支的比较；
+// 无法编译的自定义条件回退到原有的虚函数调用。
+class ConditionProgram {
+private:
+    // 区间的比较形式：(v > lo || (loClosed && v == lo)) && (v < hi || (hiClosed && v == hi))
+    struct Range {
+        double lo;
+        double hi;
+        bool loClosed;
+        bool hiClosed;
+    };
+
+    std::vector<Range> ranges_;
+    bool nanResult_ = false;
+    std::shared_ptr<IAlarmCondition> fallback_; // 非空表示未能编译
+
+    static bool inRange(const Range& r, double v) {
+        bool lower = (v > r.lo) | (r.loClosed & (v == r.lo));
+        bool upper = (v < r.hi) | (r.hiClosed & (v == r.hi));
+        return lower & upper;
+    }
+
+    // 单个区间的批量累加；区间互不相交，命中时 acc[i] 恰好加 1
+    // 比较结果以 0.0/1.0 的double表示，与输入同宽，开启自动向量化时基线SSE2即可处理
+    template<bool LoClosed, bool HiClosed>
+    static void accumulateRange(const double* v, size_t n, double lo, double hi, double* acc) {
+        for (size_t i = 0; i < n; ++i) {
+            const double x = v[i];
+            const double lower = (LoClosed ? x >= lo : x > lo) ? 1.0 : 0.0;
+            const double upper = (HiClosed ? x <= hi : x < hi) ? 1.0 : 0.0;
+            acc[i] += lower * upper;
+        }
+    }
+
+public:
+    ConditionProgram() = default;
+
+    // 编译条件树；condition 为空时程序恒为false
+    static ConditionProgram compile(const std::shared_ptr<IAlarmCondition>& condition) {
+        ConditionProgram program;
+        if (!condition) {
+            return program;
+        }
+        IntervalSet set;
+        if (!condition->toIntervals(set)) {
+            program.fallback_ = condition;
+            return program;
+        }
+        for (const auto& iv : set.intervals()) {
+            program.ranges_.push_back({iv.lo, iv.hi, iv.loClosed, iv.hiClosed});
+        }
+        program.nanResult_ = set.containsNaN();
+        return program;
+    }
+
+    bool isCompiled() const {
+        return !fallback_;
+    }
+
+    size_t size() const {
+        return ranges_.size();
+    }
+
+    bool evaluate(double value) const {
+        if (fallback_) {
+            return fallback_->isTriggered(value);
+        }
+        bool hit = nanResult_ & (value != value);
+        for (const auto& r : ranges_) {
+            hit |= inRange(r, value);
+        }
+        return hit;
+    }
+
+    // 批量求值：out[i] = 条件(values[i]) ? 1 : 0
+    // 按块累加到局部缓冲区，块内外层按区间、内层按数值循环，内层循环无分支。
+    // 项目默认的 -O2 下（GCC 12）为无分支的标量循环，-O3 或加 -ftree-vectorize 时才被向量化
+    void evaluateBatch(const double* values, size_t count, uint8_t* out) const {
+        if (fallback_) {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = fallback_->isTriggered(values[i]) ? 1 : 0;
+            }
+            return;
+        }
+        const double nanResult = nanResult_ ? 1.0 : 0.0;
+        const size_t kBlock = 256;
+        double acc[kBlock];
+        for (size_t base = 0; base < count; base += kBlock) {
+            const size_t n = std::min(kBlock, count - base);
+            const double* v = values + base;
+            for (size_t i = 0; i < n; ++i) {
+                acc[i] = (v[i] != v[i]) ? nanResult : 0.0;
+            }
+            for (const auto& r : ranges_) {
+                if (r.loClosed) {
+                    if (r.hiClosed) accumulateRange<true, true>(v, n, r.lo, r.hi, acc);
+                    else accumulateRange<true, false>(v, n, r.lo, r.hi, acc);
+                } else {
+                    if (r.hiClosed) accumulateRange<false, true>(v, n, r.lo, r.hi, acc);
+                    else accumulateRange<false, false>(v, n, r.lo, r.hi, acc);
+                }
+            }
+            for (size_t i = 0; i < n; ++i) {
+                out[base + i] = acc[i] != 0.0 ? 1 : 0;
+            }
+        }
+    }
+};
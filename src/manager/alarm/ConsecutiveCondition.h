@@ -0,0 +1,55 @@
+// ConsecutiveCondition.h
+#pragma once
+#include "IAlarmCondition.h"
+#include <memory>
+#include <sstream>
+
+// 连续N个样本满足内层条件才触发，用于抑制单点毛刺
+// 内层条件也可以是有状态条件（如窗口条件），其状态嵌套在本条件的状态中。
+class ConsecutiveCondition : public IAlarmCondition {
+private:
+    struct State : ConditionState {
+        std::unique_ptr<ConditionState> inner;
+        size_t streak = 0;
+    };
+
+    std::shared_ptr<IAlarmCondition> inner_;
+    size_t count_;
+
+public:
+    ConsecutiveCondition(std::shared_ptr<IAlarmCondition> inner, size_t count)
+        : inner_(std::move(inner)), count_(count == 0 ? 1 : count) {}
+
+    bool isTriggered(double value) const override {
+        return count_ == 1 && inner_->isTriggered(value);
+    }
+
+    std::unique_ptr<ConditionState> createState() const override {
+        std::unique_ptr<State> state(new State());
+        state->inner = inner_->createState();
+        return std::unique_ptr<ConditionState>(std::move(state));
+    }
+
+    void addSample(ConditionState& state, double value, TimePoint ts) const override {
+        State& s = static_cast<State&>(state);
+        bool hit;
+        if (s.inner) {
+            inner_->addSample(*s.inner, value, ts);
+            hit = inner_->isStateTriggered(*s.inner, ts);
+        } else {
+            hit = inner_->isTriggered(value);
+        }
+        s.streak = hit ? s.streak + 1 : 0;
+    }
+
+    bool isStateTriggered(ConditionState& state, TimePoint now) const override {
+        (void)now;
+        return static_cast<State&>(state).streak >= count_;
+    }
+
+    std::string getDescription() const override {
+        std::ostringstream oss;
+        oss << inner_->getDescription() << " for " << count_ << " consecutive samples";
+        return oss.str();
+    }
+};
@@ -3,6 +3,7 @@
 #include "IAlarmAction.h"
 #include "AlarmEventRepository.h"
 #include <memory>
+#include <vector>
 
 class DatabaseAction : public IAlarmAction {
 private:
@@ -22,4 +23,21 @@ public:
         std::string details = "Event recorded via DatabaseAction.";
         repository_->insertEvent(ruleId, resourceName, eventType_, details);
     }
+
+    // 整批在一个事务内写入
+    void executeBatch(const std::vector<AlarmActionEvent>& events) override {
+        std::vector<AlarmEventRecord> records;
+        records.reserve(events.size());
+        for (const auto& event : events) {
+            std::string details = "Event recorded via DatabaseAction.";
+            if (!event.members.empty()) {
+                details = "Grouped alarm of " + std::to_string(event.members.size()) + " nodes:";
+                for (const auto& member : event.members) {
+                    details += " " + member;
+                }
+            }
+            records.push_back({event.ruleId, event.resourceName, eventType_, details, event.time, event.members});
+        }
+        repository_->insertEvents(records);
+    }
 };
\ No newline at end of file
@@ -0,0 +1,28 @@
+// DeviationCondition.h
+#pragma once
+#include "IAlarmCondition.h"
+#include "ConditionProgram.h"
+#include <cmath>
+#include <sstream>
+
+// 偏离基线超过 k 个标准差时触发
+// 作用于 MetricCache::enableBaseline 生成的 "<metric>_zscore" 指标，该指标即样本相对本节点基线的z分数；
+// 基线预热期间z分数为NaN，不会触发。
+class DeviationCondition : public IAlarmCondition {
+private:
+    double sigmas_;
+public:
+    explicit DeviationCondition(double sigmas) : sigmas_(std::fabs(sigmas)) {}
+    bool isTriggered(double value) const override {
+        return std::fabs(value) > sigmas_;
+    }
+    bool toIntervals(IntervalSet& out) const override {
+        out = IntervalSet::lessThan(-sigmas_).unite(IntervalSet::greaterThan(sigmas_));
+        return true;
+    }
+    std::string getDescription() const override {
+        std::ostringstream oss;
+        oss << "deviates more than " << sigmas_ << " sigma from baseline";
+        return oss.str();
+    }
+};
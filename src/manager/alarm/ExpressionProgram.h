@@ -0,0 +1,394 @@
+// ExpressionProgram.h
+#pragma once
+#include "MetricCache.h"
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cctype>
+#include <cstdlib>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+// 基于节点多个指标的表达式，例如：
+//   memory_used / memory_total > 0.9 && cpu_load_avg_1m > cpu_core_count
+// 表达式在编译时解析为带类型检查的后缀字节码，指标名解析为 MetricCache 的驻留ID，
+// 求值时只做数组下标访问，不做字符串查找或JSON访问。
+//
+// 语法（优先级从低到高）：
+//   ||  &&  !  比较(> >= < <= == !=)  + -  * /  一元-  数字/指标名/函数(abs,min,max)/括号
+// 类型：算术运算与比较的操作数必须为数值，逻辑运算的操作数必须为布尔；
+// 布尔值以 1.0/0.0 表示。NaN（指标缺失）沿所有运算传播，包括比较、!、&&、||、min/max，
+// 读到缺失指标的表达式结果为NaN，模板按未触发处理（!(cpu > 90) 在 cpu 缺失时同样不触发）。
+// 括号、函数调用、! 与一元 - 的嵌套层数不超过 kMaxNesting。
+class ExpressionProgram {
+public:
+    enum class Type {
+        NUMBER,
+        BOOLEAN
+    };
+
+    // 解析并编译表达式；语法或类型错误时抛出 std::invalid_argument
+    static ExpressionProgram compile(const std::string& source, MetricCache& cache) {
+        Parser parser(source, cache);
+        ExpressionProgram program;
+        program.source_ = source;
+        program.type_ = parser.parse(program.code_);
+        program.computeStackDepth();
+        return program;
+    }
+
+    Type getType() const { return type_; }
+    const std::string& getSource() const { return source_; }
+
+    // 标量求值；load(MetricId) 返回该指标的当前值（缺失时为NaN）
+    template<typename Load>
+    double evaluate(Load&& load) const {
+        double stack[kMaxStack];
+        stack[0] = std::numeric_limits<double>::quiet_NaN(); // 编译成功的程序至少有一条指令，这里只为消除未初始化告警
+        size_t top = 0;
+        for (const auto& ins : code_) {
+            switch (ins.op) {
+                case Op::CONST: stack[top++] = ins.value; break;
+                case Op::LOAD: stack[top++] = load(ins.metric); break;
+                case Op::NEG: stack[top - 1] = -stack[top - 1]; break;
+                case Op::NOT: stack[top - 1] = applyNot(stack[top - 1]); break;
+                case Op::ABS: stack[top - 1] = std::fabs(stack[top - 1]); break;
+                default:
+                    --top;
+                    stack[top - 1] = applyBinary(ins.op, stack[top - 1], stack[top]);
+                    break;
+            }
+        }
+        return stack[0];
+    }
+
+    // 列式求值：out[i] 为第 i 个节点的结果；按块执行，每条指令处理一整块数据
+    void evaluateBatch(const MetricCache::ShardView& view, size_t count, double* out) const {
+        const size_t kBlock = 256;
+        // 每个线程复用同一块栈空间，求值过程中不分配内存
+        thread_local std::vector<double> stack;
+        if (stack.size() < maxDepth_ * kBlock) {
+            stack.resize(maxDepth_ * kBlock);
+        }
+        for (size_t base = 0; base < count; base += kBlock) {
+            const size_t n = std::min(kBlock, count - base);
+            size_t top = 0;
+            for (const auto& ins : code_) {
+                double* dst = &stack[top * kBlock];
+                switch (ins.op) {
+                    case Op::CONST:
+                        std::fill(dst, dst + n, ins.value);
+                        ++top;
+                        break;
+                    case Op::LOAD: {
+                        const double* column = view.column(ins.metric);
+                        if (column) {
+                            std::copy(column + base, column + base + n, dst);
+                        } else {
+                            std::fill(dst, dst + n, std::numeric_limits<double>::quiet_NaN());
+                        }
+                        ++top;
+                        break;
+                    }
+                    case Op::NEG:
+                    case Op::NOT:
+                    case Op::ABS: {
+                        double* a = &stack[(top - 1) * kBlock];
+                        for (size_t i = 0; i < n; ++i) {
+                            a[i] = ins.op == Op::NEG ? -a[i] : ins.op == Op::ABS ? std::fabs(a[i]) : applyNot(a[i]);
+                        }
+                        break;
+                    }
+                    default: {
+                        --top;
+                        double* a = &stack[(top - 1) * kBlock];
+                        const double* b = &stack[top * kBlock];
+                        for (size_t i = 0; i < n; ++i) {
+                            a[i] = applyBinary(ins.op, a[i], b[i]);
+                        }
+                        break;
+                    }
+                }
+            }
+            std::copy(stack.begin(), stack.begin() + n, out + base);
+        }
+    }
+
+private:
+    static const size_t kMaxStack = 64;
+    static const size_t kMaxNesting = 64;
+
+    enum class Op : uint8_t {
+        CONST, LOAD,
+        NEG, NOT, ABS,
+        ADD, SUB, MUL, DIV, MIN, MAX,
+        GT, GE, LT, LE, EQ, NE,
+        AND, OR
+    };
+
+    struct Instruction {
+        Op op;
+        MetricCache::MetricId metric;
+        double value;
+    };
+
+    std::string source_;
+    Type type_ = Type::BOOLEAN;
+    std::vector<Instruction> code_;
+    size_t maxDepth_ = 1;
+
+    static double applyNot(double a) {
+        return std::isnan(a) ? a : (a != 0.0 ? 0.0 : 1.0);
+    }
+
+    static double applyBinary(Op op, double a, double b) {
+        if (std::isnan(a) || std::isnan(b)) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        switch (op) {
+            case Op::ADD: return a + b;
+            case Op::SUB: return a - b;
+            case Op::MUL: return a * b;
+            case Op::DIV: return a / b;
+            case Op::MIN: return std::min(a, b);
+            case Op::MAX: return std::max(a, b);
+            case Op::GT: return a > b ? 1.0 : 0.0;
+            case Op::GE: return a >= b ? 1.0 : 0.0;
+            case Op::LT: return a < b ? 1.0 : 0.0;
+            case Op::LE: return a <= b ? 1.0 : 0.0;
+            case Op::EQ: return a == b ? 1.0 : 0.0;
+            case Op::NE: return a != b ? 1.0 : 0.0;
+            case Op::AND: return (a != 0.0 && b != 0.0) ? 1.0 : 0.0;
+            case Op::OR: return (a != 0.0 || b != 0.0) ? 1.0 : 0.0;
+            default: return std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+
+    void computeStackDepth() {
+        size_t depth = 0;
+        maxDepth_ = 1;
+        for (const auto& ins : code_) {
+            if (ins.op == Op::CONST || ins.op == Op::LOAD) {
+                maxDepth_ = std::max(maxDepth_, ++depth);
+            } else if (ins.op != Op::NEG && ins.op != Op::NOT && ins.op != Op::ABS) {
+                --depth;
+            }
+        }
+        if (maxDepth_ > kMaxStack) {
+            throw std::invalid_argument("Expression too deeply nested: " + source_);
+        }
+    }
+
+    // 递归下降解析器，直接生成后缀字节码并做类型检查
+    class Parser {
+    public:
+        Parser(const std::string& source, MetricCache& cache) : src_(source), cache_(cache) {}
+
+        Type parse(std::vector<Instruction>& code) {
+            code_ = &code;
+            Type type = parseOr();
+            skipSpaces();
+            if (pos_ != src_.size()) {
+                fail("unexpected '" + src_.substr(pos_, 1) + "'");
+            }
+            return type;
+        }
+
+    private:
+        const std::string& src_;
+        MetricCache& cache_;
+        size_t pos_ = 0;
+        size_t depth_ = 0;
+        std::vector<Instruction>* code_ = nullptr;
+
+        // 递归进入一层嵌套，超过 kMaxNesting 时报错，避免病态输入耗尽调用栈
+        struct Nested {
+            Parser& parser;
+            explicit Nested(Parser& p) : parser(p) {
+                if (++parser.depth_ > kMaxNesting) {
+                    parser.fail("expression nested too deeply");
+                }
+            }
+            ~Nested() { --parser.depth_; }
+        };
+
+        [[noreturn]] void fail(const std::string& message) const {
+            throw std::invalid_argument("Expression error at " + std::to_string(pos_) + ": " + message +
+                                        " in \"" + src_ + "\"");
+        }
+
+        void emit(Op op, MetricCache::MetricId metric = 0, double value = 0.0) {
+            code_->push_back({op, metric, value});
+        }
+
+        void skipSpaces() {
+            while (pos_ < src_.size() && std::isspace(static_cast<unsigned char>(src_[pos_]))) ++pos_;
+        }
+
+        bool accept(const char* token) {
+            skipSpaces();
+            size_t len = std::char_traits<char>::length(token);
+            if (src_.compare(pos_, len, token) != 0) return false;
+            // 关键字须是完整单词
+            if (std::isalpha(static_cast<unsigned char>(token[0])) && pos_ + len < src_.size() &&
+                (std::isalnum(static_cast<unsigned char>(src_[pos_ + len])) || src_[pos_ + len] == '_')) {
+                return false;
+            }
+            pos_ += len;
+            return true;
+        }
+
+        void expect(Type actual, Type expected, const char* what) {
+            if (actual != expected) {
+                fail(std::string(what) + (expected == Type::NUMBER ? " requires numeric operands" : " requires boolean operands"));
+            }
+        }
+
+        Type parseOr() {
+            Type left = parseAnd();
+            while (accept("||") || accept("or") || accept("OR")) {
+                expect(left, Type::BOOLEAN, "'||'");
+                expect(parseAnd(), Type::BOOLEAN, "'||'");
+                emit(Op::OR);
+            }
+            return left;
+        }
+
+        Type parseAnd() {
+            Type left = parseNot();
+            while (accept("&&") || accept("and") || accept("AND")) {
+                expect(left, Type::BOOLEAN, "'&&'");
+                expect(parseNot(), Type::BOOLEAN, "'&&'");
+                emit(Op::AND);
+            }
+            return left;
+        }
+
+        Type parseNot() {
+            skipSpaces();
+            // '!=' 不是取反
+            if ((pos_ < src_.size() && src_[pos_] == '!' && src_.compare(pos_, 2, "!=") != 0 && accept("!")) ||
+                accept("not") || accept("NOT")) {
+                Nested nested(*this);
+                expect(parseNot(), Type::BOOLEAN, "'!'");
+                emit(Op::NOT);
+                return Type::BOOLEAN;
+            }
+            return parseComparison();
+        }
+
+        Type parseComparison() {
+            Type left = parseAdditive();
+            static const struct { const char* token; Op op; } kComparisons[] = {
+                {">=", Op::GE}, {"<=", Op::LE}, {"==", Op::EQ}, {"!=", Op::NE}, {">", Op::GT}, {"<", Op::LT}
+            };
+            for (const auto& cmp : kComparisons) {
+                if (accept(cmp.token)) {
+                    expect(left, Type::NUMBER, cmp.token);
+                    expect(parseAdditive(), Type::NUMBER, cmp.token);
+                    emit(cmp.op);
+                    return Type::BOOLEAN;
+                }
+            }
+            return left;
+        }
+
+        Type parseAdditive() {
+            Type left = parseMultiplicative();
+            while (true) {
+                Op op;
+                if (accept("+")) op = Op::ADD;
+                else if (accept("-")) op = Op::SUB;
+                else return left;
+                expect(left, Type::NUMBER, "arithmetic");
+                expect(parseMultiplicative(), Type::NUMBER, "arithmetic");
+                emit(op);
+            }
+        }
+
+        Type parseMultiplicative() {
+            Type left = parseUnary();
+            while (true) {
+                Op op;
+                if (accept("*")) op = Op::MUL;
+                else if (accept("/")) op = Op::DIV;
+                else return left;
+                expect(left, Type::NUMBER, "arithmetic");
+                expect(parseUnary(), Type::NUMBER, "arithmetic");
+                emit(op);
+            }
+        }
+
+        Type parseUnary() {
+            if (accept("-")) {
+                Nested nested(*this);
+                expect(parseUnary(), Type::NUMBER, "unary '-'");
+                emit(Op::NEG);
+                return Type::NUMBER;
+            }
+            return parsePrimary();
+        }
+
+        Type parsePrimary() {
+            skipSpaces();
+            if (pos_ >= src_.size()) fail("unexpected end of expression");
+            char c = src_[pos_];
+            if (accept("(")) {
+                Nested nested(*this);
+                Type type = parseOr();
+                if (!accept(")")) fail("expected ')'");
+                return type;
+            }
+            if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+                const char* begin = src_.c_str() + pos_;
+                char* end = nullptr;
+                double value = std::strtod(begin, &end);
+                if (end == begin) fail("invalid number");
+                pos_ += static_cast<size_t>(end - begin);
+                emit(Op::CONST, 0, value);
+                return Type::NUMBER;
+            }
+            if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+                size_t start = pos_;
+                while (pos_ < src_.size() &&
+                       (std::isalnum(static_cast<unsigned char>(src_[pos_])) || src_[pos_] == '_' || src_[pos_] == '.')) {
+                    ++pos_;
+                }
+                std::string name = src_.substr(start, pos_ - start);
+                if (accept("(")) {
+                    return parseCall(name);
+                }
+                emit(Op::LOAD, cache_.internMetric(name));
+                return Type::NUMBER;
+            }
+            fail(std::string("unexpected '") + c + "'");
+        }
+
+        Type parseCall(const std::string& name) {
+            Nested nested(*this);
+            std::vector<Type> args;
+            if (!accept(")")) {
+                do {
+                    args.push_back(parseOr());
+                } while (accept(","));
+                if (!accept(")")) fail("expected ')'");
+            }
+            for (Type type : args) {
+                expect(type, Type::NUMBER, name.c_str());
+            }
+            if (name == "abs" && args.size() == 1) {
+                emit(Op::ABS);
+            } else if ((name == "min" || name == "max") && args.size() >= 2) {
+                for (size_t i = 1; i < args.size(); ++i) {
+                    emit(name == "min" ? Op::MIN : Op::MAX);
+                }
+            } else {
+                fail("unknown function or wrong argument count: " + name);
+            }
+            return Type::NUMBER;
+        }
+    };
+};
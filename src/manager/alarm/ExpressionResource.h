@@ -0,0 +1,42 @@
+// ExpressionResource.h
+#pragma once
+#include "IResource.h"
+#include "MetricCache.h"
+#include "ExpressionProgram.h"
+#include <memory>
+#include <limits>
+#include <utility>
+
+// 代表某个节点上的多指标表达式，供单条规则使用
+// 表达式在构造时编译；取值时在一次分片加锁内读出所需的全部指标
+// 布尔表达式的值为 1.0/0.0，可配合 GreaterThanCondition(0.5) 使用
+class ExpressionResource : public IResource {
+private:
+    std::string nodeId_;
+    std::shared_ptr<MetricCache> cache_;
+    MetricCache::NodeIndex node_;
+    ExpressionProgram program_;
+
+public:
+    // 表达式有误时抛出 std::invalid_argument
+    ExpressionResource(std::string node, const std::string& expression, std::shared_ptr<MetricCache> c)
+        : nodeId_(std::move(node)), cache_(std::move(c)), node_(cache_->internNode(nodeId_)),
+          program_(ExpressionProgram::compile(expression, *cache_)) {}
+
+    double getValue() const override {
+        double value = std::numeric_limits<double>::quiet_NaN();
+        const uint32_t local = cache_->localOfIndex(node_);
+        cache_->readShard(cache_->shardOfIndex(node_), [&](const MetricCache::ShardView& view) {
+            if (local >= view.nodeCount()) return;
+            value = program_.evaluate([&](MetricCache::MetricId metric) {
+                const double* column = view.column(metric);
+                return column ? column[local] : std::numeric_limits<double>::quiet_NaN();
+            });
+        });
+        return value;
+    }
+
+    std::string getName() const override {
+        return "Expression '" + program_.getSource() + "' on node '" + nodeId_ + "'";
+    }
+};
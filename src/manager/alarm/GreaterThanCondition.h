@@ -1,6 +1,7 @@
 // GreaterThanCondition.h
 #pragma once
 #include "IAlarmCondition.h"
+#include "ConditionProgram.h"
 #include <sstream>
 
 class GreaterThanCondition : public IAlarmCondition {
@@ -11,6 +12,10 @@ public:
     bool isTriggered(double value) const override {
         return value > threshold_;
     }
+    bool toIntervals(IntervalSet& out) const override {
+        out = IntervalSet::greaterThan(threshold_);
+        return true;
+    }
     std::string getDescription() const override {
         std::ostringstream oss;
         oss << "is greater than " << threshold_;
@@ -1,6 +1,16 @@
 // IAlarmAction.h
 #pragma once
 #include <string>
+#include <vector>
+#include <chrono>
+
+// 一次待执行的告警动作调用；time 为告警状态迁移发生的时间，异步执行时不受排队延迟影响
+struct AlarmActionEvent {
+    std::string ruleId;
+    std::string resourceName;
+    std::chrono::system_clock::time_point time;
+    std::vector<std::string> members; // 聚合告警的成员节点，单个告警为空
+};
 
 // 告警动作接口，定义了告警触发后要执行的操作
 class IAlarmAction {
@@ -9,4 +19,11 @@ public:
     
     // 执行动作
     virtual void execute(const std::string& ruleId, const std::string& resourceName) = 0;
-};
\ No newline at end of file
+
+    // 批量执行，由 ActionDispatcher 调用；能合并写入的动作应覆盖此方法
+    virtual void executeBatch(const std::vector<AlarmActionEvent>& events) {
+        for (const auto& event : events) {
+            execute(event.ruleId, event.resourceName);
+        }
+    }
+};
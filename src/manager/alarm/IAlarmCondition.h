@@ -1,10 +1,22 @@
 // IAlarmCondition.h
 #pragma once
 #include <string>
+#include <memory>
+#include <chrono>
+
+class IntervalSet;
+
+// 有状态条件（如滑动窗口）的运行状态，每条规则/每个节点各持有一份
+class ConditionState {
+public:
+    virtual ~ConditionState() = default;
+};
 
 // 告警条件接口，定义了触发告警的逻辑
 class IAlarmCondition {
 public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
     virtual ~IAlarmCondition() = default;
     
     // 检查给定值是否触发条件
@@ -12,4 +24,38 @@ public:
     
     // 获取条件的文字描述
     virtual std::string getDescription() const = 0;
-};
\ No newline at end of file
+
+    // 将条件展开为触发值的区间集合，供 ConditionProgram 编译；
+    // 无法用区间表示的条件返回false，求值时回退到 isTriggered
+    virtual bool toIntervals(IntervalSet& out) const {
+        (void)out;
+        return false;
+    }
+
+    // 有状态条件返回非空状态；条件对象本身仍可被多条规则共享
+    virtual std::unique_ptr<ConditionState> createState() const {
+        return nullptr;
+    }
+
+    // 向状态并入一个新样本（仅对 createState 返回非空的条件调用）
+    virtual void addSample(ConditionState& state, double value, TimePoint ts) const {
+        (void)state;
+        (void)value;
+        (void)ts;
+    }
+
+    // 按当前状态判断是否触发；now 用于淘汰按时长计算的窗口中的过期样本
+    virtual bool isStateTriggered(ConditionState& state, TimePoint now) const {
+        (void)state;
+        (void)now;
+        return false;
+    }
+
+    // 不再有新样本时，isStateTriggered 的结果最早可能在何时变化（如窗口内最旧样本过期）；
+    // 模板评估据此在没有新上报时按时重新检查。默认不随时间变化
+    virtual TimePoint nextStateChange(const ConditionState& state, TimePoint now) const {
+        (void)state;
+        (void)now;
+        return TimePoint::max();
+    }
+};
@@ -1,6 +1,7 @@
 // LessThanCondition.h
 #pragma once
 #include "IAlarmCondition.h"
+#include "ConditionProgram.h"
 #include <sstream>
 
 class LessThanCondition : public IAlarmCondition {
@@ -11,6 +12,10 @@ public:
     bool isTriggered(double value) const override {
         return value < threshold_;
     }
+    bool toIntervals(IntervalSet& out) const override {
+        out = IntervalSet::lessThan(threshold_);
+        return true;
+    }
     std::string getDescription() const override {
         std::ostringstream oss;
         oss << "is less than " << threshold_;
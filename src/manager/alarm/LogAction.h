@@ -2,23 +2,41 @@
 #pragma once
 #include "IAlarmAction.h"
 #include <iostream>
+#include <sstream>
 #include <chrono>
 #include <ctime>
-#include <cstring>
 
 class LogAction : public IAlarmAction {
+private:
+    static void appendLine(std::ostream& os, const std::string& ruleId, const std::string& resourceName,
+                           std::chrono::system_clock::time_point time) {
+        auto now = std::chrono::system_clock::to_time_t(time);
+        // 可能有多个分发线程同时写日志，localtime 的静态缓冲区不可共用
+        std::tm local_tm;
+        localtime_r(&now, &local_tm);
+        char time_str[30];
+        std::strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", &local_tm);
+
+        os << "\033[1;31m" // Set color to bold red
+           << "[ALARM TRIGGERED] " << time_str
+           << " | Rule ID: " << ruleId
+           << " | Details: " << resourceName
+           << "\033[0m" << '\n'; // Reset color
+    }
+
 public:
     void execute(const std::string& ruleId, const std::string& resourceName) override {
-        auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-        char time_str[30];
-        // ctime_s(time_str, sizeof(time_str), &now);
-        std::strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
-        time_str[strlen(time_str) - 1] = '\0'; // Remove newline
+        appendLine(std::cout, ruleId, resourceName, std::chrono::system_clock::now());
+        std::cout.flush();
+    }
 
-        std::cout << "\033[1;31m" // Set color to bold red
-                  << "[ALARM TRIGGERED] " << time_str
-                  << " | Rule ID: " << ruleId
-                  << " | Details: " << resourceName
-                  << "\033[0m" << std::endl; // Reset color
+    // 整批拼接后一次写出、一次刷新
+    void executeBatch(const std::vector<AlarmActionEvent>& events) override {
+        std::ostringstream oss;
+        for (const auto& event : events) {
+            appendLine(oss, event.ruleId, event.resourceName, event.time);
+        }
+        std::cout << oss.str();
+        std::cout.flush();
     }
-};
\ No newline at end of file
+};
@@ -1,10 +1,19 @@
 // MetricCache.h
 #pragma once
 #include <string>
-#include <map>
 #include <set>
+#include <vector>
+#include <unordered_map>
 #include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <memory>
 #include <chrono>
+#include <functional>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
 #include <utility>
 #include <nlohmann/json.hpp>
 #include <iostream>
@@ -13,48 +22,538 @@ using json = nlohmann::json;
 // 节点的指标快照
 using MetricSnapshot = json;
 
+// 类型化的指标更新：指标名 -> 数值
+using MetricSamples = std::vector<std::pair<std::string, double>>;
+
 // 线程安全的中心化缓存，存储所有节点的最新指标
+// 指标名与节点ID均被驻留为稠密整数ID，数值按指标分列连续存放，未上报的值为NaN。
+// 节点按ID哈希划分到多个分片，每个分片独立加锁：
+//   NodeIndex = 分片内下标 * 分片数 + 分片号
+// 不同节点的上报与告警读取只在同一分片上才会竞争。
+// 指标名注册表为读多写少，使用读写锁。
+// 驻留后的ID在缓存生命周期内保持不变，可由资源对象预先解析并缓存。
+// 节点的加入与过期以事件形式通知（见 setMembershipListener），订阅方无需轮询活跃节点集合。
 class MetricCache {
+public:
+    using MetricId = uint32_t;
+    using NodeIndex = uint32_t;
+    using TimePoint = std::chrono::time_point<std::chrono::steady_clock>;
+
+    // 节点指标更新后的回调，参数为节点ID
+    using UpdateListener = std::function<void(const std::string&)>;
+
+    // 节点成员变化：首次上报（或过期后重新上报）为 JOINED，超时未上报为 EXPIRED
+    enum class NodeEvent {
+        JOINED,
+        EXPIRED
+    };
+    using MembershipListener = std::function<void(NodeIndex, const std::string&, NodeEvent)>;
+
+    // 在线基线的参数：alpha 为EWMA平滑系数；前 1/alpha 个样本按Welford累计均值/方差，之后按EWMA衰减；
+    // 样本数达到 warmup 前不输出z分数；标准差低于 minStdDev 时按 minStdDev 计算，避免平稳指标被微小波动放大；
+    // 预热后并入基线的样本限制在均值 ± clipSigmas 个标准差内，使持续异常不会迅速把基线拉过去（0表示不限制）
+    struct BaselineConfig {
+        double alpha = 0.05;
+        uint32_t warmup = 30;
+        double minStdDev = 1e-6;
+        double clipSigmas = 3.0;
+    };
+
+    // 单个节点单个指标的基线，12字节
+    struct Baseline {
+        float mean = 0.0f;
+        float variance = 0.0f;
+        uint32_t count = 0;
+    };
+
+    // 锁竞争统计：获取次数与其中需要等待的次数
+    struct ContentionStats {
+        uint64_t acquisitions = 0;
+        uint64_t contended = 0;
+    };
+
 private:
-    struct NodeData {
-        MetricSnapshot metrics;
-        std::chrono::time_point<std::chrono::steady_clock> lastUpdated;
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, uint32_t> localIndices;
+        std::vector<std::string> nodeNames;
+        std::vector<std::vector<double>> columns; // [metricId][local]，按需增长
+        std::vector<TimePoint> lastUpdated;       // [local]，从未上报为 TimePoint::min()
+        std::vector<uint8_t> active;              // [local]，已发出 JOINED 且尚未 EXPIRED
+        std::vector<std::vector<Baseline>> baselines; // [基线序号][local]，按需增长
+
+        std::atomic<uint64_t> version{0};         // 每次写入递增，供评估方判断分片是否有新数据
+
+        mutable std::atomic<uint64_t> acquisitions{0};
+        mutable std::atomic<uint64_t> contended{0};
     };
 
-    std::map<std::string, NodeData> cache_;
-    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    std::unordered_map<std::string, MetricId> metricIds_;
+    std::vector<std::string> metricNames_;
+    mutable std::shared_timed_mutex registryMutex_;
+
+    // 启用了在线基线的指标，受 registryMutex_ 保护
+    struct BaselineTracker {
+        MetricId source;
+        MetricId zscore;
+        BaselineConfig config;
+    };
+    std::vector<BaselineTracker> trackers_;
+    std::vector<int32_t> trackerOfMetric_; // [metricId] -> trackers_下标，-1表示未启用
+
+    UpdateListener listener_;
+    MembershipListener membershipListener_;
+
+    // 先尝试加锁，失败则计为一次竞争后再阻塞等待
+    std::unique_lock<std::mutex> lockShard(const Shard& shard) const {
+        std::unique_lock<std::mutex> lock(shard.mutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            shard.contended.fetch_add(1, std::memory_order_relaxed);
+            lock.lock();
+        }
+        shard.acquisitions.fetch_add(1, std::memory_order_relaxed);
+        return lock;
+    }
+
+    size_t shardOf(const std::string& nodeId) const {
+        return std::hash<std::string>()(nodeId) % shards_.size();
+    }
+
+    NodeIndex toNodeIndex(size_t shard, uint32_t local) const {
+        return static_cast<NodeIndex>(local * shards_.size() + shard);
+    }
+
+    // 调用方须持有分片锁
+    uint32_t internLocal(Shard& shard, const std::string& nodeId) {
+        auto it = shard.localIndices.find(nodeId);
+        if (it != shard.localIndices.end()) {
+            return it->second;
+        }
+        uint32_t local = static_cast<uint32_t>(shard.nodeNames.size());
+        shard.localIndices.emplace(nodeId, local);
+        shard.nodeNames.push_back(nodeId);
+        shard.lastUpdated.push_back(TimePoint::min());
+        shard.active.push_back(0);
+        for (auto& column : shard.columns) {
+            column.push_back(std::numeric_limits<double>::quiet_NaN());
+        }
+        return local;
+    }
+
+    // 调用方须持有分片锁
+    double* cell(Shard& shard, MetricId metric, uint32_t local) {
+        while (shard.columns.size() <= metric) {
+            shard.columns.emplace_back(shard.nodeNames.size(), std::numeric_limits<double>::quiet_NaN());
+        }
+        return &shard.columns[metric][local];
+    }
+
+    // 用更新前的基线计算z分数，再把样本并入基线；调用方须持有分片锁
+    static double updateBaseline(Baseline& b, double x, const BaselineConfig& config) {
+        double z = std::numeric_limits<double>::quiet_NaN();
+        if (std::isnan(x)) return z;
+        if (b.count >= config.warmup) {
+            double stddev = std::max(std::sqrt(static_cast<double>(b.variance)), config.minStdDev);
+            z = (x - b.mean) / stddev;
+            if (config.clipSigmas > 0) {
+                double bound = config.clipSigmas * stddev;
+                x = std::min(std::max(x, b.mean - bound), b.mean + bound);
+            }
+        }
+        // alpha取 max(alpha, 1/n)：样本较少时等价于Welford累计统计，之后为EWMA
+        ++b.count;
+        double alpha = std::max(config.alpha, 1.0 / b.count);
+        double diff = x - b.mean;
+        double increment = alpha * diff;
+        b.mean = static_cast<float>(b.mean + increment);
+        b.variance = static_cast<float>((1.0 - alpha) * (b.variance + diff * increment));
+        return z;
+    }
+
+    void notifyUpdated(const std::string& nodeId) const {
+        // 回调在锁外执行，避免与告警管理器互相持锁
+        if (listener_) {
+            listener_(nodeId);
+        }
+    }
+
+    // 调用方须持有分片锁；index 为 trackers_ 下标
+    static Baseline& baselineCell(Shard& shard, size_t index, uint32_t local) {
+        if (shard.baselines.size() <= index) {
+            shard.baselines.resize(index + 1);
+        }
+        auto& column = shard.baselines[index];
+        if (column.size() <= local) {
+            column.resize(shard.nodeNames.size());
+        }
+        return column[local];
+    }
+
+    void notifyMembership(NodeIndex node, const std::string& nodeId, NodeEvent event) const {
+        if (membershipListener_) {
+            membershipListener_(node, nodeId, event);
+        }
+    }
 
 public:
-    // 由数据接收端调用，更新节点的指标
-    void updateNodeMetrics(const std::string& nodeId, MetricSnapshot metrics) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        cache_[nodeId] = {std::move(metrics), std::chrono::steady_clock::now()};
+    // 分片的只读视图，仅在 readShard 回调内有效（期间持有分片锁）
+    class ShardView {
+    public:
+        explicit ShardView(const Shard& shard) : shard_(shard) {}
+
+        size_t nodeCount() const { return shard_.nodeNames.size(); }
+
+        // 指标在该分片的整列数值；该分片从未收到此指标时返回nullptr
+        const double* column(MetricId metric) const {
+            return metric < shard_.columns.size() ? shard_.columns[metric].data() : nullptr;
+        }
+
+        const std::string& nodeName(uint32_t local) const { return shard_.nodeNames[local]; }
+
+        // 节点最近一次上报的时间，从未上报为 TimePoint::min()
+        TimePoint lastUpdated(uint32_t local) const { return shard_.lastUpdated[local]; }
+
+    private:
+        const Shard& shard_;
+    };
+
+    explicit MetricCache(size_t shardCount = 16) {
+        if (shardCount == 0) shardCount = 1;
+        shards_.reserve(shardCount);
+        for (size_t i = 0; i < shardCount; ++i) {
+            shards_.emplace_back(new Shard());
+        }
+    }
+
+    // 设置更新回调（须在开始接收数据前设置）
+    void setUpdateListener(UpdateListener listener) {
+        listener_ = std::move(listener);
+    }
+
+    // 与 setUpdateListener 相同，须在开始写入前设置。
+    // 回调在节点所在分片的锁内调用，同一节点的事件按状态变化的顺序送达；
+    // 回调只能做入队等轻量操作，不得再访问本缓存
+    void setMembershipListener(MembershipListener listener) {
+        membershipListener_ = std::move(listener);
+    }
+
+    size_t getShardCount() const {
+        return shards_.size();
+    }
+
+    // 节点ID所在的分片，告警评估按同样的分片划分并行任务
+    size_t shardOfNode(const std::string& nodeId) const {
+        return shardOf(nodeId);
+    }
+
+    // NodeIndex 与 (分片号, 分片内下标) 之间的换算
+    size_t shardOfIndex(NodeIndex node) const {
+        return node % shards_.size();
     }
 
-    // 由资源对象调用，获取特定节点的特定指标
+    uint32_t localOfIndex(NodeIndex node) const {
+        return static_cast<uint32_t>(node / shards_.size());
+    }
+
+    NodeIndex makeNodeIndex(size_t shard, uint32_t local) const {
+        return toNodeIndex(shard, local);
+    }
+
+    // 分片的写入版本号，未变化说明自上次读取后没有新数据
+    uint64_t getShardVersion(size_t shard) const {
+        return shards_[shard]->version.load(std::memory_order_acquire);
+    }
+
+    // 在分片锁内以只读视图访问整个分片，用于按列批量评估
+    template<typename Fn>
+    void readShard(size_t shard, Fn&& fn) const {
+        const Shard& s = *shards_[shard];
+        auto lock = lockShard(s);
+        fn(ShardView(s));
+    }
+
+    // 驻留指标名，返回稠密ID
+    MetricId internMetric(const std::string& metricName) {
+        {
+            std::shared_lock<std::shared_timed_mutex> lock(registryMutex_);
+            auto it = metricIds_.find(metricName);
+            if (it != metricIds_.end()) {
+                return it->second;
+            }
+        }
+        std::unique_lock<std::shared_timed_mutex> lock(registryMutex_);
+        auto it = metricIds_.find(metricName);
+        if (it != metricIds_.end()) {
+            return it->second;
+        }
+        MetricId id = static_cast<MetricId>(metricNames_.size());
+        metricIds_.emplace(metricName, id);
+        metricNames_.push_back(metricName);
+        return id;
+    }
+
+    // 对指标启用在线基线（每次上报O(1)更新），返回其z分数指标的ID
+    // z分数写入名为 "<metricName>_zscore" 的指标列，可直接用于模板、规则与表达式
+    MetricId enableBaseline(const std::string& metricName) {
+        return enableBaseline(metricName, BaselineConfig());
+    }
+
+    MetricId enableBaseline(const std::string& metricName, const BaselineConfig& config) {
+        MetricId source = internMetric(metricName);
+        MetricId zscore = internMetric(zscoreMetricName(metricName));
+        std::unique_lock<std::shared_timed_mutex> lock(registryMutex_);
+        if (trackerOfMetric_.size() <= source) {
+            trackerOfMetric_.resize(source + 1, -1);
+        }
+        if (trackerOfMetric_[source] >= 0) {
+            trackers_[trackerOfMetric_[source]].config = config;
+        } else {
+            trackerOfMetric_[source] = static_cast<int32_t>(trackers_.size());
+            trackers_.push_back({source, zscore, config});
+        }
+        return zscore;
+    }
+
+    static std::string zscoreMetricName(const std::string& metricName) {
+        return metricName + "_zscore";
+    }
+
+    // 读取节点某指标的基线；未启用或无数据时 count 为0
+    Baseline getBaseline(const std::string& nodeId, const std::string& metricName) const {
+        int32_t index = -1;
+        {
+            std::shared_lock<std::shared_timed_mutex> lock(registryMutex_);
+            auto it = metricIds_.find(metricName);
+            if (it != metricIds_.end() && it->second < trackerOfMetric_.size()) {
+                index = trackerOfMetric_[it->second];
+            }
+        }
+        if (index < 0) return Baseline();
+        const Shard& shard = *shards_[shardOf(nodeId)];
+        auto lock = lockShard(shard);
+        auto nodeIt = shard.localIndices.find(nodeId);
+        if (nodeIt == shard.localIndices.end() || static_cast<size_t>(index) >= shard.baselines.size() ||
+            nodeIt->second >= shard.baselines[index].size()) {
+            return Baseline();
+        }
+        return shard.baselines[index][nodeIt->second];
+    }
+
+    // 驻留节点ID，返回稠密下标
+    NodeIndex internNode(const std::string& nodeId) {
+        size_t shardNo = shardOf(nodeId);
+        Shard& shard = *shards_[shardNo];
+        auto lock = lockShard(shard);
+        return toNodeIndex(shardNo, internLocal(shard, nodeId));
+    }
+
+    std::string getNodeId(NodeIndex node) const {
+        const Shard& shard = *shards_[node % shards_.size()];
+        uint32_t local = static_cast<uint32_t>(node / shards_.size());
+        auto lock = lockShard(shard);
+        return local < shard.nodeNames.size() ? shard.nodeNames[local] : std::string();
+    }
+
+    // 由数据接收端调用，按指标合并类型化的更新
+    void updateNodeMetrics(const std::string& nodeId, const MetricSamples& samples) {
+        // 指标名在分片锁外解析，写入时只持有该节点所在分片的锁
+        std::vector<MetricId> ids;
+        ids.reserve(samples.size());
+        for (const auto& sample : samples) {
+            ids.push_back(internMetric(sample.first));
+        }
+        struct Tracked {
+            size_t sample;
+            size_t index;
+            BaselineTracker tracker;
+        };
+        std::vector<Tracked> tracked;
+        {
+            std::shared_lock<std::shared_timed_mutex> lock(registryMutex_);
+            if (!trackers_.empty()) {
+                for (size_t i = 0; i < ids.size(); ++i) {
+                    if (ids[i] < trackerOfMetric_.size() && trackerOfMetric_[ids[i]] >= 0) {
+                        size_t index = static_cast<size_t>(trackerOfMetric_[ids[i]]);
+                        tracked.push_back({i, index, trackers_[index]});
+                    }
+                }
+            }
+        }
+
+        size_t shardNo = shardOf(nodeId);
+        Shard& shard = *shards_[shardNo];
+        uint32_t local;
+        bool joined;
+        {
+            auto lock = lockShard(shard);
+            local = internLocal(shard, nodeId);
+            for (size_t i = 0; i < samples.size(); ++i) {
+                *cell(shard, ids[i], local) = samples[i].second;
+            }
+            for (const auto& t : tracked) {
+                Baseline& baseline = baselineCell(shard, t.index, local);
+                *cell(shard, t.tracker.zscore, local) = updateBaseline(baseline, samples[t.sample].second, t.tracker.config);
+            }
+            shard.lastUpdated[local] = std::chrono::steady_clock::now();
+            joined = !shard.active[local];
+            shard.active[local] = 1;
+            shard.version.fetch_add(1, std::memory_order_release);
+            // 在分片锁内通知，与 expireInactiveNodes 的 EXPIRED 按状态变化的顺序送达
+            if (joined) {
+                notifyMembership(toNodeIndex(shardNo, local), nodeId, NodeEvent::JOINED);
+            }
+        }
+        notifyUpdated(nodeId);
+    }
+
+    // 兼容接口：只取快照中的数值字段
+    void updateNodeMetrics(const std::string& nodeId, const MetricSnapshot& metrics) {
+        MetricSamples samples;
+        if (metrics.is_object()) {
+            for (auto it = metrics.begin(); it != metrics.end(); ++it) {
+                if (it.value().is_number()) {
+                    samples.emplace_back(it.key(), it.value().get<double>());
+                }
+            }
+        }
+        updateNodeMetrics(nodeId, samples);
+    }
+
+    // 由资源对象调用，按驻留ID直接索引；无数据时返回NaN
+    double getMetric(NodeIndex node, MetricId metric) const {
+        const Shard& shard = *shards_[node % shards_.size()];
+        uint32_t local = static_cast<uint32_t>(node / shards_.size());
+        auto lock = lockShard(shard);
+        if (metric >= shard.columns.size() || local >= shard.lastUpdated.size()) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        return shard.columns[metric][local];
+    }
+
+    // 按名称查询，获取特定节点的特定指标；无数据时返回NaN
     double getMetric(const std::string& nodeId, const std::string& metricName) const {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto nodeIt = cache_.find(nodeId);
-        if (nodeIt != cache_.end()) {
-            const auto& metrics = nodeIt->second.metrics;
-            // 打印metrics
-            if (metrics.contains(metricName)) {
-                return metrics.at(metricName).get<double>();
+        MetricId metric;
+        {
+            std::shared_lock<std::shared_timed_mutex> lock(registryMutex_);
+            auto metricIt = metricIds_.find(metricName);
+            if (metricIt == metricIds_.end()) {
+                return std::numeric_limits<double>::quiet_NaN();
+            }
+            metric = metricIt->second;
+        }
+        const Shard& shard = *shards_[shardOf(nodeId)];
+        auto lock = lockShard(shard);
+        auto nodeIt = shard.localIndices.find(nodeId);
+        if (nodeIt == shard.localIndices.end() || metric >= shard.columns.size()) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        return shard.columns[metric][nodeIt->second];
+    }
+
+    // 由规则供应器调用，获取所有活跃节点的驻留下标
+    std::vector<NodeIndex> getActiveNodeIndices(std::chrono::seconds timeout = std::chrono::minutes(5)) const {
+        std::vector<NodeIndex> activeNodes;
+        for (size_t shardNo = 0; shardNo < shards_.size(); ++shardNo) {
+            const Shard& shard = *shards_[shardNo];
+            auto lock = lockShard(shard);
+            auto now = std::chrono::steady_clock::now();
+            for (uint32_t local = 0; local < shard.lastUpdated.size(); ++local) {
+                const TimePoint& updated = shard.lastUpdated[local];
+                if (updated != TimePoint::min() && (now - updated) < timeout) {
+                    activeNodes.push_back(toNodeIndex(shardNo, local));
+                }
+            }
+        }
+        return activeNodes;
+    }
+
+    // 将超过 timeout 未上报的活跃节点标记为过期并发出 EXPIRED 事件，返回过期节点数
+    // 只比较时间戳，不涉及字符串；由规则供应器定期调用
+    size_t expireInactiveNodes(std::chrono::seconds timeout = std::chrono::minutes(5)) {
+        size_t expired = 0;
+        for (size_t shardNo = 0; shardNo < shards_.size(); ++shardNo) {
+            Shard& shard = *shards_[shardNo];
+            auto lock = lockShard(shard);
+            auto now = std::chrono::steady_clock::now();
+            for (uint32_t local = 0; local < shard.active.size(); ++local) {
+                if (shard.active[local] && (now - shard.lastUpdated[local]) >= timeout) {
+                    shard.active[local] = 0;
+                    // 在分片锁内通知：节点若随即重新上报，其 JOINED 必然排在这条 EXPIRED 之后
+                    notifyMembership(toNodeIndex(shardNo, local), shard.nodeNames[local], NodeEvent::EXPIRED);
+                    ++expired;
+                }
             }
         }
-        return 0.0;
+        return expired;
     }
 
-    // 由规则供应器调用，获取所有活跃的节点ID
+    // 获取所有活跃的节点ID
+    // 逐个分片加锁，任一时刻只阻塞一个分片的写入
     std::set<std::string> getActiveNodeIds(std::chrono::seconds timeout = std::chrono::minutes(5)) const {
-        std::lock_guard<std::mutex> lock(mutex_);
         std::set<std::string> activeNodes;
-        auto now = std::chrono::steady_clock::now();
-        for (const auto& pair : cache_) {
-            if ((now - pair.second.lastUpdated) < timeout) {
-                activeNodes.insert(pair.first);
+        std::vector<std::string> shardActive;
+        for (const auto& shardPtr : shards_) {
+            const Shard& shard = *shardPtr;
+            shardActive.clear();
+            {
+                auto lock = lockShard(shard);
+                auto now = std::chrono::steady_clock::now();
+                for (size_t local = 0; local < shard.lastUpdated.size(); ++local) {
+                    const TimePoint& updated = shard.lastUpdated[local];
+                    if (updated != TimePoint::min() && (now - updated) < timeout) {
+                        shardActive.push_back(shard.nodeNames[local]);
+                    }
+                }
             }
+            activeNodes.insert(shardActive.begin(), shardActive.end());
         }
         return activeNodes;
     }
-};
\ No newline at end of file
+
+    // 所有分片的锁竞争统计之和
+    ContentionStats getContentionStats() const {
+        ContentionStats total;
+        for (const auto& shard : shards_) {
+            total.acquisitions += shard->acquisitions.load(std::memory_order_relaxed);
+            total.contended += shard->contended.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    // 各分片的统计，便于观察热点分片
+    json getStats() const {
+        json shardStats = json::array();
+        size_t nodes = 0;
+        for (const auto& shard : shards_) {
+            size_t shardNodes;
+            {
+                auto lock = lockShard(*shard);
+                shardNodes = shard->nodeNames.size();
+            }
+            nodes += shardNodes;
+            shardStats.push_back({
+                {"nodes", shardNodes},
+                {"lock_acquisitions", shard->acquisitions.load(std::memory_order_relaxed)},
+                {"lock_contended", shard->contended.load(std::memory_order_relaxed)}
+            });
+        }
+        ContentionStats total = getContentionStats();
+        size_t metrics;
+        size_t baselines;
+        {
+            std::shared_lock<std::shared_timed_mutex> lock(registryMutex_);
+            metrics = metricNames_.size();
+            baselines = trackers_.size();
+        }
+        return {
+            {"nodes", nodes},
+            {"metrics", metrics},
+            {"baseline_metrics", baselines},
+            {"lock_acquisitions", total.acquisitions},
+            {"lock_contended", total.contended},
+            {"shards", shardStats}
+        };
+    }
+};
@@ -1,6 +1,7 @@
 // NotCondition.h
 #pragma once
 #include "IAlarmCondition.h"
+#include "ConditionProgram.h"
 #include <memory>
 #include <utility>
 
@@ -16,6 +17,15 @@ public:
         return !condition_->isTriggered(value);
     }
 
+    bool toIntervals(IntervalSet& out) const override {
+        IntervalSet child;
+        if (!condition_->toIntervals(child)) {
+            return false;
+        }
+        out = child.complement();
+        return true;
+    }
+
     std::string getDescription() const override {
         return "NOT (" + condition_->getDescription() + ")";
     }
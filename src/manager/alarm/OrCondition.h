@@ -1,6 +1,7 @@
 // OrCondition.h
 #pragma once
 #include "IAlarmCondition.h"
+#include "ConditionProgram.h"
 #include <vector>
 #include <memory>
 #include <sstream>
@@ -22,6 +23,19 @@ public:
         return false; // 所有都为false
     }
 
+    bool toIntervals(IntervalSet& out) const override {
+        IntervalSet result = IntervalSet::empty();
+        for (const auto& cond : conditions_) {
+            IntervalSet child;
+            if (!cond->toIntervals(child)) {
+                return false;
+            }
+            result = result.unite(child);
+        }
+        out = result;
+        return true;
+    }
+
     std::string getDescription() const override {
         std::stringstream ss;
         ss << "(";
@@ -0,0 +1,48 @@
+// ResourceMetrics.h
+#pragma once
+#include "MetricCache.h"
+#include <string>
+#include <map>
+#include <algorithm>
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+
+// 将Agent上报的resource对象展开为告警可用的类型化指标
+//   对象字段 (cpu/memory/docker):  "<family>_<field>"，如 cpu_usage_percent
+//   数组字段 (disk/gpu/network):   "<family>_max_<field>"，取所有设备中的最大值
+inline MetricSamples extractResourceMetrics(const json& resource) {
+    MetricSamples samples;
+    if (!resource.is_object()) {
+        return samples;
+    }
+
+    for (auto family = resource.begin(); family != resource.end(); ++family) {
+        const json& value = family.value();
+        if (value.is_object()) {
+            for (auto field = value.begin(); field != value.end(); ++field) {
+                if (field.value().is_number()) {
+                    samples.emplace_back(family.key() + "_" + field.key(), field.value().get<double>());
+                }
+            }
+        } else if (value.is_array()) {
+            std::map<std::string, double> maxima;
+            for (const auto& device : value) {
+                if (!device.is_object()) continue;
+                for (auto field = device.begin(); field != device.end(); ++field) {
+                    if (!field.value().is_number()) continue;
+                    double v = field.value().get<double>();
+                    auto it = maxima.find(field.key());
+                    if (it == maxima.end()) {
+                        maxima.emplace(field.key(), v);
+                    } else {
+                        it->second = std::max(it->second, v);
+                    }
+                }
+            }
+            for (const auto& pair : maxima) {
+                samples.emplace_back(family.key() + "_max_" + pair.first, pair.second);
+            }
+        }
+    }
+    return samples;
+}
@@ -3,68 +3,150 @@
 #include "AlarmRuleTemplate.h"
 #include "AlarmManager.h"
 #include "MetricCache.h"
-#include "AgentResource.h" // 需要用它来创建Resource实例
 #include <vector>
+#include <set>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <atomic>
+#include <chrono>
 #include <iostream>
 
-// 规则供应器，负责动态管理告警规则实例
+// 规则供应器，负责把活跃节点纳管到告警模板上
+// 模板本身注册到告警管理器后按列评估，供应器只维护"哪些节点被纳管"，不再为每个节点生成规则。
+// 纳管由 MetricCache 的节点加入/过期事件增量驱动；全量对齐只作为低频的兜底。
 class RuleProvisioner {
 private:
-    std::vector<AlarmRuleTemplate> templates_;
+    struct PendingEvent {
+        MetricCache::NodeIndex node;
+        std::string nodeId;
+        MetricCache::NodeEvent event;
+    };
+
     std::shared_ptr<AlarmManager> alarmManager_;
     std::shared_ptr<MetricCache> metricCache_;
+    std::set<MetricCache::NodeIndex> enrolled_; // 仅工作线程访问
+
+    std::vector<PendingEvent> pending_;
+    std::mutex pendingMutex_;
+    std::condition_variable pendingCv_;
+
+    std::chrono::seconds nodeTimeout_{std::chrono::minutes(5)};
+    std::chrono::seconds expiryCheckInterval_{5};
+    std::chrono::seconds reconcileInterval_{std::chrono::minutes(10)};
+
     std::atomic<bool> stopRequested_{false};
     std::thread workerThread_;
 
-    void synchronizeRules() {
-        std::set<std::string> activeNodeIds = metricCache_->getActiveNodeIds();
-        std::set<std::string> existingRuleIds = alarmManager_->getManagedRuleIds();
-        std::set<std::string> requiredRuleIds;
-
-        for (const auto& tpl : templates_) {
-            for (const auto& nodeId : activeNodeIds) {
-                std::string ruleId = tpl.templateId + ":" + nodeId;
-                requiredRuleIds.insert(ruleId);
-
-                if (existingRuleIds.find(ruleId) == existingRuleIds.end()) {
-                    std::cout << "[Provisioner] New rule needed for '" << ruleId << "'. Creating..." << std::endl;
-                    AlarmRule newRule;
-                    newRule.ruleId = ruleId;
-                    newRule.resource = std::make_shared<AgentResource>(nodeId, tpl.metricName, metricCache_);
-                    newRule.condition = tpl.condition;
-                    newRule.actions = tpl.actions;
-                    alarmManager_->addRule(newRule);
+    // 增量应用一批节点事件，同一批内的纳管与移出各只提交一次
+    void applyEvents(const std::vector<PendingEvent>& events) {
+        std::vector<MetricCache::NodeIndex> toEnroll;
+        std::vector<MetricCache::NodeIndex> toRetire;
+        for (const auto& e : events) {
+            if (e.event == MetricCache::NodeEvent::JOINED) {
+                if (enrolled_.insert(e.node).second) {
+                    std::cout << "[Provisioner] Node '" << e.nodeId << "' joined. Enrolling..." << std::endl;
+                    toEnroll.push_back(e.node);
                 }
+            } else if (enrolled_.erase(e.node)) {
+                std::cout << "[Provisioner] Node '" << e.nodeId << "' expired. Retiring..." << std::endl;
+                toRetire.push_back(e.node);
             }
         }
+        alarmManager_->enrollNodes(toEnroll);
+        alarmManager_->retireNodes(toRetire);
+    }
 
-        for (const auto& existingId : existingRuleIds) {
-            if (requiredRuleIds.find(existingId) == requiredRuleIds.end()) {
-                if (existingId.find(':') != std::string::npos) { // 只删除由模板生成的规则
-                    std::cout << "[Provisioner] Stale rule found: '" << existingId << "'. Removing..." << std::endl;
-                    alarmManager_->removeRule(existingId);
-                }
+    // 全量对齐：以缓存中的活跃节点为准修正纳管集合，弥补可能丢失或乱序的事件
+    void synchronizeRules() {
+        std::vector<MetricCache::NodeIndex> active = metricCache_->getActiveNodeIndices(nodeTimeout_);
+        std::set<MetricCache::NodeIndex> activeSet(active.begin(), active.end());
+        std::vector<MetricCache::NodeIndex> toEnroll;
+        std::vector<MetricCache::NodeIndex> toRetire;
+
+        for (auto node : activeSet) {
+            if (enrolled_.insert(node).second) {
+                std::cout << "[Provisioner] Node '" << metricCache_->getNodeId(node) << "' enrolled by reconciliation." << std::endl;
+                toEnroll.push_back(node);
+            }
+        }
+        for (auto it = enrolled_.begin(); it != enrolled_.end();) {
+            if (activeSet.find(*it) == activeSet.end()) {
+                std::cout << "[Provisioner] Node '" << metricCache_->getNodeId(*it) << "' is stale. Retiring..." << std::endl;
+                toRetire.push_back(*it);
+                it = enrolled_.erase(it);
+            } else {
+                ++it;
             }
         }
+
+        alarmManager_->enrollNodes(toEnroll);
+        alarmManager_->retireNodes(toRetire);
     }
 
     void run() {
+        synchronizeRules(); // 启动时对齐一次已有节点
+        auto now = std::chrono::steady_clock::now();
+        auto nextExpiryCheck = now + expiryCheckInterval_;
+        auto nextReconcile = now + reconcileInterval_;
+
         while (!stopRequested_) {
-            synchronizeRules();
-            std::this_thread::sleep_for(std::chrono::seconds(20)); // 同步不需要太频繁
+            std::vector<PendingEvent> events;
+            {
+                std::unique_lock<std::mutex> lock(pendingMutex_);
+                pendingCv_.wait_until(lock, std::min(nextExpiryCheck, nextReconcile), [this] {
+                    return stopRequested_ || !pending_.empty();
+                });
+                events.swap(pending_);
+            }
+            if (stopRequested_) break;
+
+            applyEvents(events);
+
+            now = std::chrono::steady_clock::now();
+            if (now >= nextExpiryCheck) {
+                // 过期事件经回调重新进入 pending_，在下一轮处理
+                metricCache_->expireInactiveNodes(nodeTimeout_);
+                nextExpiryCheck = now + expiryCheckInterval_;
+            }
+            if (now >= nextReconcile) {
+                synchronizeRules();
+                nextReconcile = now + reconcileInterval_;
+            }
         }
     }
 
 public:
     RuleProvisioner(std::shared_ptr<AlarmManager> am, std::shared_ptr<MetricCache> mc)
         : alarmManager_(std::move(am)), metricCache_(std::move(mc)) {}
-    
+
     void addTemplate(const AlarmRuleTemplate& tpl) {
-        templates_.push_back(tpl);
+        alarmManager_->addTemplate(tpl);
     }
-    
+
+    // 由 MetricCache 的成员变化回调调用，只入队，不阻塞写入线程
+    void onNodeEvent(MetricCache::NodeIndex node, const std::string& nodeId, MetricCache::NodeEvent event) {
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex_);
+            pending_.push_back({node, nodeId, event});
+        }
+        pendingCv_.notify_one();
+    }
+
+    // 节点超过该时长未上报即视为过期
+    void setNodeTimeout(std::chrono::seconds timeout) {
+        nodeTimeout_ = timeout;
+    }
+
+    void setExpiryCheckInterval(std::chrono::seconds interval) {
+        expiryCheckInterval_ = interval;
+    }
+
+    // 兜底全量对齐的周期
+    void setReconcileInterval(std::chrono::seconds interval) {
+        reconcileInterval_ = interval;
+    }
+
     void start() {
         if (workerThread_.joinable()) return;
         stopRequested_ = false;
@@ -73,10 +155,14 @@ public:
     }
 
     void stop() {
-        stopRequested_ = true;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex_);
+            stopRequested_ = true;
+        }
+        pendingCv_.notify_all();
         if (workerThread_.joinable()) {
             workerThread_.join();
         }
         std::cout << "[RuleProvisioner] Stopped." << std::endl;
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,148 @@
+// SlidingWindow.h
+#pragma once
+#include <vector>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+
+// 固定容量的滑动窗口
+// 样本按序号 seq 存放在环形缓冲区 ring_[seq % capacity] 中，窗口为 [seq_ - size_, seq_)。
+// 和在入队/出队时增量维护（每绕环一圈重算一次以消除浮点误差累积）；
+// 最大/最小值各用一个单调队列维护，队列同样是以序号为元素的定长环，不做动态分配。
+class SlidingWindow {
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    SlidingWindow(size_t capacity, bool trackMax, bool trackMin)
+        : capacity_(capacity == 0 ? 1 : capacity), ring_(capacity_),
+          maxQueue_(trackMax ? capacity_ : 0), minQueue_(trackMin ? capacity_ : 0) {}
+
+    // 追加一个样本，窗口已满时淘汰最旧的样本；NaN被忽略
+    void push(double value, TimePoint ts) {
+        if (std::isnan(value)) return;
+        if (size_ == capacity_) {
+            popOldest();
+        }
+        ring_[seq_ % capacity_] = {value, ts};
+        sum_ += value;
+        ++size_;
+        if (!maxQueue_.empty()) pushMonotonic(maxQueue_, maxHead_, maxSize_, value, true);
+        if (!minQueue_.empty()) pushMonotonic(minQueue_, minHead_, minSize_, value, false);
+        ++seq_;
+        if (seq_ % capacity_ == 0) {
+            recomputeSum();
+        }
+    }
+
+    // 淘汰时间戳早于 cutoff 的样本
+    void expireBefore(TimePoint cutoff) {
+        while (size_ > 0 && ring_[oldestSeq() % capacity_].ts < cutoff) {
+            popOldest();
+        }
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+
+    // 最旧样本的时间戳，窗口不能为空
+    TimePoint oldestTime() const {
+        return ring_[oldestSeq() % capacity_].ts;
+    }
+
+    // 以下聚合在窗口为空时返回NaN
+    double sum() const {
+        return size_ ? sum_ : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    double average() const {
+        return size_ ? sum_ / static_cast<double>(size_) : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    double max() const {
+        return maxSize_ ? valueAt(maxQueue_[maxHead_]) : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    double min() const {
+        return minSize_ ? valueAt(minQueue_[minHead_]) : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    // 最近秩法求分位数，p 取 (0, 1]；复制窗口后做一次 nth_element，O(窗口大小)
+    double percentile(double p) const {
+        if (size_ == 0) return std::numeric_limits<double>::quiet_NaN();
+        thread_local std::vector<double> scratch;
+        scratch.clear();
+        for (uint64_t s = oldestSeq(); s < seq_; ++s) {
+            scratch.push_back(valueAt(s));
+        }
+        size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(size_)));
+        size_t index = rank == 0 ? 0 : std::min(rank, size_) - 1;
+        std::nth_element(scratch.begin(), scratch.begin() + index, scratch.end());
+        return scratch[index];
+    }
+
+private:
+    struct Sample {
+        double value;
+        TimePoint ts;
+    };
+
+    size_t capacity_;
+    std::vector<Sample> ring_;
+    uint64_t seq_ = 0;   // 下一个样本的序号
+    size_t size_ = 0;
+    double sum_ = 0.0;
+
+    // 单调队列：存放样本序号，对应值自队首起单调不增（max）或不减（min）
+    std::vector<uint64_t> maxQueue_;
+    size_t maxHead_ = 0;
+    size_t maxSize_ = 0;
+    std::vector<uint64_t> minQueue_;
+    size_t minHead_ = 0;
+    size_t minSize_ = 0;
+
+    uint64_t oldestSeq() const {
+        return seq_ - size_;
+    }
+
+    double valueAt(uint64_t seq) const {
+        return ring_[seq % capacity_].value;
+    }
+
+    void popOldest() {
+        uint64_t oldest = oldestSeq();
+        sum_ -= valueAt(oldest);
+        --size_;
+        if (maxSize_ && maxQueue_[maxHead_] == oldest) {
+            maxHead_ = (maxHead_ + 1) % capacity_;
+            --maxSize_;
+        }
+        if (minSize_ && minQueue_[minHead_] == oldest) {
+            minHead_ = (minHead_ + 1) % capacity_;
+            --minSize_;
+        }
+        if (size_ == 0) {
+            sum_ = 0.0;
+        }
+    }
+
+    // 弹出队尾所有被新值支配的序号后入队；每个序号至多入队出队各一次，均摊O(1)
+    void pushMonotonic(std::vector<uint64_t>& queue, size_t head, size_t& size, double value, bool isMax) {
+        while (size > 0) {
+            double back = valueAt(queue[(head + size - 1) % capacity_]);
+            if (isMax ? back > value : back < value) break;
+            --size;
+        }
+        queue[(head + size) % capacity_] = seq_;
+        ++size;
+    }
+
+    void recomputeSum() {
+        sum_ = 0.0;
+        for (uint64_t s = oldestSeq(); s < seq_; ++s) {
+            sum_ += valueAt(s);
+        }
+    }
+};
@@ -0,0 +1,110 @@
+// StormAggregator.h
+#pragma once
+#include "AlarmRuleTemplate.h"
+#include <map>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+
+// 一次聚合后的通知：同一模板在窗口内同方向迁移的所有成员节点
+struct AlarmNotification {
+    std::shared_ptr<const AlarmRuleTemplate> tpl;
+    bool triggered;
+    std::vector<std::string> members;
+};
+
+// 告警风暴聚合器，位于模板评估与动作执行之间，仅由检查线程访问
+// 某模板出现第一个迁移时打开一个窗口，窗口结束时把期间的迁移按方向各合并为一条通知。
+// 成员数少于 minGroupSize 的通知仍按节点逐条发出，单点告警只多出一个窗口的延迟。
+// 窗口内先触发又恢复（或反之）的成员相互抵消，不产生任何动作；
+// 每个成员的触发状态仍由 TemplateEvaluator 的位图维护，恢复按成员逐个检测后再聚合。
+class StormAggregator {
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    StormAggregator(std::chrono::milliseconds window = std::chrono::milliseconds(2000), size_t minGroupSize = 3)
+        : window_(window), minGroupSize_(minGroupSize < 2 ? 2 : minGroupSize) {}
+
+    void configure(std::chrono::milliseconds window, size_t minGroupSize) {
+        window_ = window;
+        minGroupSize_ = minGroupSize < 2 ? 2 : minGroupSize;
+    }
+
+    // 窗口为0时不聚合
+    bool enabled() const {
+        return window_.count() > 0;
+    }
+
+    void add(const std::shared_ptr<const AlarmRuleTemplate>& tpl, const std::string& nodeId, bool triggered,
+             TimePoint now) {
+        auto it = pending_.find(tpl->templateId);
+        if (it == pending_.end()) {
+            Pending pending;
+            pending.tpl = tpl;
+            pending.deadline = now + window_;
+            it = pending_.emplace(tpl->templateId, std::move(pending)).first;
+        }
+        Pending& pending = it->second;
+        pending.tpl = tpl; // 模板被替换时以最新版本为准
+        auto member = pending.members.find(nodeId);
+        if (member != pending.members.end() && member->second != triggered) {
+            pending.members.erase(member); // 窗口内往返，相互抵消
+        } else {
+            pending.members[nodeId] = triggered;
+        }
+    }
+
+    // 最早到期的窗口；没有待处理的窗口时返回false
+    bool nextDeadline(TimePoint& deadline) const {
+        bool found = false;
+        for (const auto& pair : pending_) {
+            if (!found || pair.second.deadline < deadline) {
+                deadline = pair.second.deadline;
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    // 输出所有到期窗口的通知；force 为true时忽略期限（停止时使用）
+    void flush(TimePoint now, bool force, std::vector<AlarmNotification>& out) {
+        for (auto it = pending_.begin(); it != pending_.end();) {
+            if (!force && it->second.deadline > now) {
+                ++it;
+                continue;
+            }
+            emit(it->second, true, out);
+            emit(it->second, false, out);
+            it = pending_.erase(it);
+        }
+    }
+
+private:
+    struct Pending {
+        std::shared_ptr<const AlarmRuleTemplate> tpl;
+        TimePoint deadline;
+        std::map<std::string, bool> members; // nodeId -> 迁移方向
+    };
+
+    std::chrono::milliseconds window_;
+    size_t minGroupSize_;
+    std::map<std::string, Pending> pending_; // templateId -> 窗口
+
+    void emit(const Pending& pending, bool triggered, std::vector<AlarmNotification>& out) const {
+        std::vector<std::string> members;
+        for (const auto& member : pending.members) {
+            if (member.second == triggered) {
+                members.push_back(member.first);
+            }
+        }
+        if (members.empty()) return;
+        if (members.size() >= minGroupSize_) {
+            out.push_back({pending.tpl, triggered, std::move(members)});
+            return;
+        }
+        for (auto& member : members) {
+            out.push_back({pending.tpl, triggered, {std::move(member)}});
+        }
+    }
+};
@@ -0,0 +1,113 @@
+// SweepPool.h
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+// 告警评估的工作线程池
+// run 把一次检查拆成若干独立任务（按分片），由池中线程与调用线程共同领取，全部完成后返回。
+// 任务之间不共享可写状态，池本身只在每次 run 的开始与结束各同步一次。
+// 线程数为0时所有任务在调用线程上顺序执行。
+class SweepPool {
+private:
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable startCv_;
+    std::condition_variable doneCv_;
+    bool stopRequested_ = false;
+    uint64_t generation_ = 0;
+    size_t pending_ = 0;                          // 本轮尚未完成的池线程数
+
+    const std::function<void(size_t)>* task_ = nullptr;
+    size_t taskCount_ = 0;
+    std::atomic<size_t> nextTask_{0};
+
+    void work() {
+        size_t index;
+        while ((index = nextTask_.fetch_add(1, std::memory_order_relaxed)) < taskCount_) {
+            (*task_)(index);
+        }
+    }
+
+    // seen 为线程创建时的轮次：resize 可能发生在若干次 run 之后，新线程只参与之后的轮次
+    void loop(uint64_t seen) {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                startCv_.wait(lock, [&] { return stopRequested_ || generation_ != seen; });
+                if (stopRequested_) return;
+                seen = generation_;
+            }
+            work();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (--pending_ == 0) {
+                    doneCv_.notify_one();
+                }
+            }
+        }
+    }
+
+public:
+    explicit SweepPool(size_t threads = 0) {
+        resize(threads);
+    }
+
+    ~SweepPool() {
+        resize(0);
+    }
+
+    // 调整池线程数；不得与 run 并发调用
+    void resize(size_t threads) {
+        if (threads == threads_.size()) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopRequested_ = true;
+        }
+        startCv_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+        threads_.clear();
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopRequested_ = false;
+            generation = generation_;
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            threads_.emplace_back(&SweepPool::loop, this, generation);
+        }
+    }
+
+    size_t size() const {
+        return threads_.size();
+    }
+
+    // 执行 task(0) .. task(count-1)，返回时全部完成
+    void run(size_t count, const std::function<void(size_t)>& task) {
+        if (threads_.empty() || count <= 1) {
+            for (size_t i = 0; i < count; ++i) {
+                task(i);
+            }
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_ = &task;
+            taskCount_ = count;
+            nextTask_.store(0, std::memory_order_relaxed);
+            pending_ = threads_.size();
+            ++generation_;
+        }
+        startCv_.notify_all();
+        work();
+        std::unique_lock<std::mutex> lock(mutex_);
+        doneCv_.wait(lock, [this] { return pending_ == 0; });
+        task_ = nullptr;
+    }
+};
@@ -0,0 +1,222 @@
+// TemplateEvaluator.h
+#pragma once
+#include "AlarmRuleTemplate.h"
+#include "ConditionProgram.h"
+#include "ExpressionProgram.h"
+#include "MetricCache.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <limits>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+
+// 模板在规则集中的编译形式；slot/serial 的含义同单条规则
+struct CompiledTemplate {
+    std::shared_ptr<const AlarmRuleTemplate> tpl;
+    std::shared_ptr<const ConditionProgram> program;
+    MetricCache::MetricId metric;
+    std::shared_ptr<const ExpressionProgram> expression; // 非空时按表达式计算整列数值，metric 不使用
+    uint32_t slot;
+    uint64_t serial;
+    bool stateful;   // 窗口类条件：逐节点维护状态，不走批量求值
+};
+
+// 一次模板级的状态迁移，只为发生迁移的节点生成
+struct TemplateTransition {
+    const CompiledTemplate* tpl; // 指向规则集快照，持有快照期间有效
+    std::string nodeId;
+    double value;
+    bool triggered;
+};
+
+// 模板级列式评估器
+// 不再为 模板 × 节点 生成规则对象，而是对每个分片直接取出模板指标的整列数值，
+// 批量求值得到触发位图，与上一轮位图异或得到迁移，只有迁移的节点才被实例化为事件。
+// 窗口类的有状态模板无法批量求值，改为逐个纳管节点维护窗口状态，迁移检测方式不变。
+// 节点停止上报时窗口中的样本仍会随时间过期，分片因此记录其有状态模板最早的结果变化时间
+// （见 IAlarmCondition::nextStateChange），到期即视为脏分片，不必等兜底检查。
+// 状态（纳管位图、各模板的触发位图与窗口状态）按分片存放，仅由评估线程访问。
+class TemplateEvaluator {
+private:
+    struct TemplateShardState {
+        uint64_t serial = 0;
+        std::vector<uint64_t> triggered;
+        // 仅有状态模板使用，按分片内下标；sampledAt 记录已并入窗口的最近一次上报时间
+        std::vector<std::unique_ptr<ConditionState>> conditionStates;
+        std::vector<MetricCache::TimePoint> sampledAt;
+    };
+
+    struct ShardState {
+        uint64_t seenVersion = 0;
+        bool forceSweep = true;
+        IAlarmCondition::TimePoint dueAt = IAlarmCondition::TimePoint::max(); // 有状态模板需要重新检查的时间
+        std::vector<uint64_t> enrolled;             // 纳管节点位图，按分片内下标
+        std::vector<TemplateShardState> templates;  // 按模板槽位
+        std::vector<uint8_t> hits;
+        std::vector<double> nanColumn;
+        std::vector<double> expressionColumn;
+    };
+
+    std::shared_ptr<MetricCache> cache_;
+    std::vector<ShardState> shards_;
+
+    static void ensureWords(std::vector<uint64_t>& bits, size_t words) {
+        if (bits.size() < words) {
+            bits.resize(words, 0);
+        }
+    }
+
+    // 有状态模板逐个纳管节点求值：节点有新上报时才向其窗口追加样本
+    void evaluateStateful(const CompiledTemplate& tpl, const MetricCache::ShardView& view, const double* values,
+                          ShardState& shard, TemplateShardState& state) {
+        const size_t count = view.nodeCount();
+        if (state.conditionStates.size() < count) {
+            state.conditionStates.resize(count);
+            state.sampledAt.resize(count, MetricCache::TimePoint::min());
+        }
+        const auto now = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            if (!((shard.enrolled[i / 64] >> (i % 64)) & 1)) {
+                shard.hits[i] = 0;
+                continue;
+            }
+            auto& conditionState = state.conditionStates[i];
+            if (!conditionState) {
+                conditionState = tpl.tpl->condition->createState();
+                state.sampledAt[i] = MetricCache::TimePoint::min();
+            }
+            const MetricCache::TimePoint updated = view.lastUpdated(static_cast<uint32_t>(i));
+            if (updated != state.sampledAt[i]) {
+                state.sampledAt[i] = updated;
+                tpl.tpl->condition->addSample(*conditionState, values[i], updated);
+            }
+            shard.hits[i] = tpl.tpl->condition->isStateTriggered(*conditionState, now) ? 1 : 0;
+            shard.dueAt = std::min(shard.dueAt, tpl.tpl->condition->nextStateChange(*conditionState, now));
+        }
+    }
+
+public:
+    explicit TemplateEvaluator(std::shared_ptr<MetricCache> cache)
+        : cache_(std::move(cache)), shards_(cache_ ? cache_->getShardCount() : 0) {}
+
+    size_t getShardCount() const {
+        return shards_.size();
+    }
+
+    // 纳管或移出一个节点；移出时清除其触发状态，不产生恢复事件
+    void setEnrolled(MetricCache::NodeIndex node, bool enrolled) {
+        ShardState& shard = shards_[cache_->shardOfIndex(node)];
+        uint32_t local = cache_->localOfIndex(node);
+        size_t word = local / 64;
+        uint64_t bit = uint64_t(1) << (local % 64);
+        ensureWords(shard.enrolled, word + 1);
+        if (enrolled) {
+            shard.enrolled[word] |= bit;
+        } else {
+            shard.enrolled[word] &= ~bit;
+            for (auto& state : shard.templates) {
+                if (word < state.triggered.size()) {
+                    state.triggered[word] &= ~bit;
+                }
+                if (local < state.conditionStates.size()) {
+                    state.conditionStates[local].reset();
+                }
+            }
+        }
+        shard.forceSweep = true;
+    }
+
+    // 分片自上次评估后是否有新数据或纳管变化，或有状态模板的结果到了可能变化的时间
+    bool isShardDirty(size_t shard, IAlarmCondition::TimePoint now) const {
+        const ShardState& state = shards_[shard];
+        return state.forceSweep || state.seenVersion != cache_->getShardVersion(shard) || now >= state.dueAt;
+    }
+
+    // 各分片中最早的重新检查时间，没有时为 TimePoint::max()
+    IAlarmCondition::TimePoint nextDue() const {
+        IAlarmCondition::TimePoint due = IAlarmCondition::TimePoint::max();
+        for (const auto& shard : shards_) {
+            due = std::min(due, shard.dueAt);
+        }
+        return due;
+    }
+
+    // 规则集中已没有模板时清除所有重新检查时间
+    void clearDue() {
+        for (auto& shard : shards_) {
+            shard.dueAt = IAlarmCondition::TimePoint::max();
+        }
+    }
+
+    // 评估一个分片上的所有模板，迁移追加到 out
+    void sweepShard(size_t shardNo, const std::vector<CompiledTemplate>& templates,
+                    std::vector<TemplateTransition>& out) {
+        ShardState& shard = shards_[shardNo];
+        shard.forceSweep = false;
+        shard.dueAt = IAlarmCondition::TimePoint::max();
+        // 先记录版本再读取，读取期间的新写入会在下一轮被发现
+        shard.seenVersion = cache_->getShardVersion(shardNo);
+
+        cache_->readShard(shardNo, [&](const MetricCache::ShardView& view) {
+            const size_t count = view.nodeCount();
+            const size_t words = (count + 63) / 64;
+            ensureWords(shard.enrolled, words);
+            shard.hits.resize(count);
+            if (shard.nanColumn.size() < count) {
+                shard.nanColumn.resize(count, std::numeric_limits<double>::quiet_NaN());
+            }
+
+            for (const auto& tpl : templates) {
+                if (shard.templates.size() <= tpl.slot) {
+                    shard.templates.resize(tpl.slot + 1);
+                }
+                TemplateShardState& state = shard.templates[tpl.slot];
+                if (state.serial != tpl.serial) {
+                    state.serial = tpl.serial;
+                    state.triggered.assign(words, 0);
+                    state.conditionStates.clear();
+                    state.sampledAt.clear();
+                }
+                ensureWords(state.triggered, words);
+
+                const double* values;
+                if (tpl.expression) {
+                    shard.expressionColumn.resize(count);
+                    tpl.expression->evaluateBatch(view, count, shard.expressionColumn.data());
+                    values = shard.expressionColumn.data();
+                } else {
+                    values = view.column(tpl.metric);
+                    if (!values) {
+                        values = shard.nanColumn.data();
+                    }
+                }
+                if (tpl.stateful) {
+                    evaluateStateful(tpl, view, values, shard, state);
+                } else {
+                    tpl.program->evaluateBatch(values, count, shard.hits.data());
+                }
+
+                for (size_t w = 0; w < words; ++w) {
+                    const size_t base = w * 64;
+                    const size_t end = std::min(count, base + 64);
+                    uint64_t current = 0;
+                    for (size_t i = base; i < end; ++i) {
+                        current |= uint64_t(shard.hits[i]) << (i - base);
+                    }
+                    current &= shard.enrolled[w];
+
+                    uint64_t changed = current ^ state.triggered[w];
+                    state.triggered[w] = current;
+                    while (changed) {
+                        unsigned bit = static_cast<unsigned>(__builtin_ctzll(changed));
+                        changed &= changed - 1;
+                        uint32_t local = static_cast<uint32_t>(base + bit);
+                        out.push_back({&tpl, view.nodeName(local), values[local], ((current >> bit) & 1) != 0});
+                    }
+                }
+            }
+        });
+    }
+};
@@ -0,0 +1,157 @@
+// WindowCondition.h
+#pragma once
+#include "IAlarmCondition.h"
+#include "SlidingWindow.h"
+#include <memory>
+#include <chrono>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+
+// 滑动窗口聚合条件，例如 "60秒内均值 > 90"、"5分钟内P95 > 80"
+// 窗口由时长和样本容量共同限定：时长为0时只按最近 capacity 个样本计算；
+// 时长大于0时容量须能容纳整个时长内的样本，否则窗口实际只覆盖最近 capacity 个样本。
+// minSpan 大于0时，最旧样本须早于 now - minSpan（或窗口已满）才判断，
+// 避免刚开始上报或上报中断后窗口内只有寥寥几个样本时，"60秒均值" 退化为单次取值。
+// 聚合值交给内层条件判断，内层一般是阈值条件。
+class WindowCondition : public IAlarmCondition {
+public:
+    enum class Aggregate {
+        AVG,
+        MAX,
+        MIN,
+        PERCENTILE
+    };
+
+    WindowCondition(Aggregate aggregate, std::chrono::seconds duration, size_t capacity,
+                    std::shared_ptr<IAlarmCondition> inner, double percentile = 0.95, size_t minSamples = 1,
+                    std::chrono::milliseconds minSpan = std::chrono::milliseconds(0))
+        : aggregate_(aggregate), duration_(duration), capacity_(capacity), inner_(std::move(inner)),
+          percentile_(percentile), minSamples_(minSamples), minSpan_(minSpan) {}
+
+    // 单个窗口最多保留的样本数，防止过长的窗口或过短的采样间隔占用过多内存
+    static const size_t kMaxCapacity = 65536;
+
+    // 按时长的窗口至少须覆盖的时长比例
+    static constexpr double kMinCoverage = 0.8;
+
+    // 按时长的窗口；sampleInterval 为节点最短的上报间隔，容量按 时长/间隔 计算，
+    // 使整个时长内的样本都能保留。超过 kMaxCapacity 时截断并输出警告，此时窗口实际短于 duration。
+    // 样本覆盖窗口时长（截断时为容量对应的时长）的 kMinCoverage 之前不触发
+    static std::shared_ptr<WindowCondition> overDuration(Aggregate aggregate, std::chrono::seconds duration,
+                                                         std::shared_ptr<IAlarmCondition> inner,
+                                                         std::chrono::milliseconds sampleInterval = std::chrono::seconds(1)) {
+        const long long interval = std::max<long long>(1, sampleInterval.count());
+        const long long durationMs = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+        // 时长恰为间隔整数倍时两端的样本都在窗口内，多留一个
+        size_t capacity = static_cast<size_t>((durationMs + interval - 1) / interval + 1);
+        if (capacity > kMaxCapacity) {
+            std::cerr << "[WindowCondition] " << duration.count() << "s window at " << interval
+                      << "ms sampling needs " << capacity << " samples, capped at " << kMaxCapacity
+                      << "; the window covers only the latest " << kMaxCapacity << " samples." << std::endl;
+            capacity = kMaxCapacity;
+        }
+        long long span = std::min(durationMs, static_cast<long long>(capacity - 1) * interval);
+        auto minSpan = std::chrono::milliseconds(static_cast<long long>(span * kMinCoverage));
+        return std::make_shared<WindowCondition>(aggregate, duration, capacity, std::move(inner), 0.95, 1, minSpan);
+    }
+
+    // 按最近N个样本的窗口，窗口填满前不触发
+    static std::shared_ptr<WindowCondition> overSamples(Aggregate aggregate, size_t samples,
+                                                        std::shared_ptr<IAlarmCondition> inner) {
+        return std::make_shared<WindowCondition>(aggregate, std::chrono::seconds(0), samples, std::move(inner),
+                                                 0.95, samples);
+    }
+
+    // 无状态求值退化为只含当前值的窗口
+    bool isTriggered(double value) const override {
+        return inner_->isTriggered(value);
+    }
+
+    std::unique_ptr<ConditionState> createState() const override {
+        return std::unique_ptr<ConditionState>(new State(capacity_, aggregate_));
+    }
+
+    void addSample(ConditionState& state, double value, TimePoint ts) const override {
+        static_cast<State&>(state).window.push(value, ts);
+    }
+
+    bool isStateTriggered(ConditionState& state, TimePoint now) const override {
+        SlidingWindow& window = static_cast<State&>(state).window;
+        if (duration_.count() > 0) {
+            window.expireBefore(now - duration_);
+        }
+        if (window.size() == 0 || window.size() < minSamples_) {
+            return false;
+        }
+        if (minSpan_.count() > 0 && window.size() < window.capacity() && window.oldestTime() > now - minSpan_) {
+            return false;
+        }
+        return inner_->isTriggered(aggregateValue(window));
+    }
+
+    // 最旧样本过期之时，覆盖不足时还有覆盖满足之时
+    TimePoint nextStateChange(const ConditionState& state, TimePoint now) const override {
+        const SlidingWindow& window = static_cast<const State&>(state).window;
+        if (duration_.count() == 0 || window.size() == 0) {
+            return TimePoint::max();
+        }
+        // expireBefore 只淘汰严格早于 now - duration 的样本
+        TimePoint next = window.oldestTime() + duration_ + TimePoint::duration(1);
+        if (minSpan_.count() > 0 && window.size() < window.capacity() && window.oldestTime() + minSpan_ > now) {
+            next = std::min(next, window.oldestTime() + minSpan_);
+        }
+        return next;
+    }
+
+    std::string getDescription() const override {
+        std::ostringstream oss;
+        oss << aggregateName() << " over ";
+        if (duration_.count() > 0) {
+            oss << duration_.count() << "s";
+        } else {
+            oss << capacity_ << " samples";
+        }
+        oss << " " << inner_->getDescription();
+        return oss.str();
+    }
+
+private:
+    struct State : ConditionState {
+        SlidingWindow window;
+        State(size_t capacity, Aggregate aggregate)
+            : window(capacity, aggregate == Aggregate::MAX, aggregate == Aggregate::MIN) {}
+    };
+
+    Aggregate aggregate_;
+    std::chrono::seconds duration_;
+    size_t capacity_;
+    std::shared_ptr<IAlarmCondition> inner_;
+    double percentile_;
+    size_t minSamples_;
+    std::chrono::milliseconds minSpan_;
+
+    double aggregateValue(const SlidingWindow& window) const {
+        switch (aggregate_) {
+            case Aggregate::AVG: return window.average();
+            case Aggregate::MAX: return window.max();
+            case Aggregate::MIN: return window.min();
+            case Aggregate::PERCENTILE: return window.percentile(percentile_);
+        }
+        return window.average();
+    }
+
+    std::string aggregateName() const {
+        switch (aggregate_) {
+            case Aggregate::AVG: return "avg";
+            case Aggregate::MAX: return "max";
+            case Aggregate::MIN: return "min";
+            case Aggregate::PERCENTILE: {
+                std::ostringstream oss;
+                oss << "p" << percentile_ * 100;
+                return oss.str();
+            }
+        }
+        return "avg";
+    }
+};
@@ -58,10 +58,27 @@ void simulate_agent_data(std::shared_ptr<MetricCache> cache, std::atomic<bool>&
 int main() {
     // 1. 创建核心共享组件
     auto cache = std::make_shared<MetricCache>();
-    auto manager = std::make_shared<AlarmManager>();
+    auto manager = std::make_shared<AlarmManager>(cache);
     auto provisioner = std::make_shared<RuleProvisioner>(manager, cache);
     auto repository = std::make_shared<AlarmEventRepository>("alarm_events.db");
 
+    // 数据更新即触发对应节点的规则评估
+    // 回调保存在 cache 中，而 manager 与 provisioner 都持有 cache，只能弱引用，否则三者互相引用无法释放
+    std::weak_ptr<AlarmManager> weakManager = manager;
+    cache->setUpdateListener([weakManager](const std::string& nodeId) {
+        if (auto manager = weakManager.lock()) {
+            manager->markNodeDirty(nodeId);
+        }
+    });
+    // 节点加入/过期即增量纳管或移出
+    std::weak_ptr<RuleProvisioner> weakProvisioner = provisioner;
+    cache->setMembershipListener([weakProvisioner](MetricCache::NodeIndex node, const std::string& nodeId,
+                                                   MetricCache::NodeEvent event) {
+        if (auto provisioner = weakProvisioner.lock()) {
+            provisioner->onNodeEvent(node, nodeId, event);
+        }
+    });
+
     // 2. 定义告警模板
     AlarmRuleTemplate highCpuTemplate;
     highCpuTemplate.templateId = "tpl-high-cpu";
@@ -0,0 +1,145 @@
+// ActionDispatcherTest.cpp
+// 异步动作分发：按动作实例分组成批、组内保持顺序、队列满时丢弃、停止前排空
+#include "TestUtil.h"
+#include "../ActionDispatcher.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+class RecordingAction : public IAlarmAction {
+public:
+    explicit RecordingAction(bool throws = false) : throws_(throws) {}
+
+    void execute(const std::string& ruleId, const std::string& resourceName) override {
+        executeBatch({AlarmActionEvent{ruleId, resourceName, std::chrono::system_clock::now(), {}}});
+    }
+
+    void executeBatch(const std::vector<AlarmActionEvent>& events) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            batchSizes_.push_back(events.size());
+            for (const auto& event : events) {
+                ruleIds_.push_back(event.ruleId);
+            }
+        }
+        if (throws_) {
+            throw std::runtime_error("action failed");
+        }
+    }
+
+    std::vector<std::string> ruleIds() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return ruleIds_;
+    }
+
+    std::vector<size_t> batchSizes() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return batchSizes_;
+    }
+
+private:
+    bool throws_;
+    std::mutex mutex_;
+    std::vector<std::string> ruleIds_;
+    std::vector<size_t> batchSizes_;
+};
+
+AlarmActionEvent event(const std::string& ruleId) {
+    return AlarmActionEvent{ruleId, "resource", std::chrono::system_clock::now(), {}};
+}
+
+void testGroupingAndOrder() {
+    ActionDispatcher dispatcher(100, 1, 4);
+    auto a = std::make_shared<RecordingAction>();
+    auto b = std::make_shared<RecordingAction>();
+    // 启动前入队，单个工作线程按每批最多4个取出
+    for (int i = 0; i < 10; ++i) {
+        CHECK(dispatcher.enqueue(i % 3 ? a : b, event(std::to_string(i))));
+    }
+    dispatcher.start();
+    dispatcher.stop();
+
+    CHECK(a->ruleIds() == (std::vector<std::string>{"1", "2", "4", "5", "7", "8"}));
+    CHECK(b->ruleIds() == (std::vector<std::string>{"0", "3", "6", "9"}));
+    // 批 [0..3] [4..7] [8,9]，每批内每个动作一次调用
+    CHECK(a->batchSizes() == (std::vector<size_t>{2, 3, 1}));
+    CHECK(b->batchSizes() == (std::vector<size_t>{2, 1, 1}));
+
+    ActionDispatcher::Stats stats = dispatcher.getStats();
+    CHECK(stats.enqueued == 10 && stats.dispatched == 10 && stats.dropped == 0);
+    CHECK(stats.batches == 6);
+    CHECK(stats.queueDepth == 0 && stats.maxQueueDepth == 10);
+}
+
+void testDropWhenFull() {
+    ActionDispatcher dispatcher(5, 1, 256);
+    auto a = std::make_shared<RecordingAction>();
+    size_t accepted = 0;
+    for (int i = 0; i < 8; ++i) {
+        accepted += dispatcher.enqueue(a, event(std::to_string(i))) ? 1 : 0;
+    }
+    CHECK(accepted == 5);
+    dispatcher.start();
+    dispatcher.stop();
+    // 丢弃的是队列满之后到达的新事件
+    CHECK(a->ruleIds() == (std::vector<std::string>{"0", "1", "2", "3", "4"}));
+    CHECK(dispatcher.getStats().dropped == 3);
+    CHECK(dispatcher.getStatsJson()["capacity"] == 5);
+}
+
+void testFailingActionIsContained() {
+    ActionDispatcher dispatcher(100, 1, 256);
+    auto failing = std::make_shared<RecordingAction>(true);
+    auto ok = std::make_shared<RecordingAction>();
+    dispatcher.enqueue(failing, event("f"));
+    dispatcher.enqueue(ok, event("ok"));
+    dispatcher.start();
+    dispatcher.stop();
+    // 同批中其他动作照常执行，工作线程不退出
+    CHECK(ok->ruleIds().size() == 1);
+    dispatcher.start();
+    dispatcher.enqueue(ok, event("after"));
+    dispatcher.stop();
+    CHECK(ok->ruleIds().size() == 2);
+}
+
+void testConcurrentProducers() {
+    ActionDispatcher dispatcher(100000, 3, 64);
+    auto a = std::make_shared<RecordingAction>();
+    auto b = std::make_shared<RecordingAction>();
+    dispatcher.start();
+    const int kProducers = 4;
+    const int kEvents = 2000;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&, p] {
+            for (int i = 0; i < kEvents; ++i) {
+                dispatcher.enqueue(i % 2 ? a : b, event(std::to_string(p)));
+            }
+        });
+    }
+    for (auto& producer : producers) producer.join();
+    // 停止时执行完队列中剩余的动作
+    dispatcher.stop();
+
+    CHECK(a->ruleIds().size() + b->ruleIds().size() == static_cast<size_t>(kProducers * kEvents));
+    ActionDispatcher::Stats stats = dispatcher.getStats();
+    CHECK(stats.enqueued == static_cast<uint64_t>(kProducers * kEvents));
+    CHECK(stats.dispatched == stats.enqueued && stats.dropped == 0);
+}
+
+} // namespace
+
+int main() {
+    testGroupingAndOrder();
+    testDropWhenFull();
+    testFailingActionIsContained();
+    testConcurrentProducers();
+    return TEST_RESULT();
+}
@@ -0,0 +1,205 @@
+// AlarmManagerTest.cpp
+// 写时复制的规则集：每次增删发布一个新版本，检查线程与读方在写入期间始终看到完整的快照
+#include "TestUtil.h"
+#include "../AlarmManager.h"
+#include "../AgentResource.h"
+#include "../GreaterThanCondition.h"
+#include "../WindowCondition.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 记录收到的规则ID，供检查线程之外的线程读取
+class RecordingAction : public IAlarmAction {
+public:
+    void execute(const std::string& ruleId, const std::string&) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ruleIds_.push_back(ruleId);
+    }
+
+    std::vector<std::string> ruleIds() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return ruleIds_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::string> ruleIds_;
+};
+
+// 轮询等待异步结果，最多等待 timeout
+template<typename Predicate>
+bool waitFor(Predicate predicate, std::chrono::milliseconds timeout = std::chrono::milliseconds(2000)) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() >= deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+AlarmRule makeRule(const std::string& ruleId, const std::string& nodeId, const std::shared_ptr<MetricCache>& cache,
+                   double threshold, const std::shared_ptr<IAlarmAction>& action) {
+    AlarmRule rule;
+    rule.ruleId = ruleId;
+    rule.nodeId = nodeId;
+    rule.resource = std::make_shared<AgentResource>(nodeId, "cpu", cache);
+    rule.condition = std::make_shared<GreaterThanCondition>(threshold);
+    if (action) {
+        rule.actions.push_back(action);
+    }
+    return rule;
+}
+
+void testVersions() {
+    auto cache = std::make_shared<MetricCache>(4);
+    AlarmManager manager(cache);
+    CHECK(manager.getRuleSetVersion() == 0);
+
+    // 一批增删只发布一个版本
+    manager.applyChanges({makeRule("r1", "n1", cache, 90, nullptr), makeRule("r2", "n2", cache, 90, nullptr)}, {});
+    CHECK(manager.getRuleSetVersion() == 1);
+    CHECK(manager.getRuleCount() == 2);
+
+    // 同ID的规则被替换而不是重复
+    manager.addRule(makeRule("r1", "n1", cache, 80, nullptr));
+    CHECK(manager.getRuleSetVersion() == 2);
+    CHECK(manager.getRuleCount() == 2);
+
+    manager.applyChanges({makeRule("r3", "n3", cache, 90, nullptr)}, {"r1"});
+    CHECK(manager.getManagedRuleIds() == (std::set<std::string>{"r2", "r3"}));
+
+    // 空变更不发布新版本
+    manager.applyChanges({}, {});
+    CHECK(manager.getRuleSetVersion() == 3);
+    manager.removeRule("missing");
+    CHECK(manager.getRuleCount() == 2);
+}
+
+void testConcurrentWriters() {
+    auto cache = std::make_shared<MetricCache>(4);
+    AlarmManager manager(cache);
+    cache->setUpdateListener([&manager](const std::string& nodeId) { manager.markNodeDirty(nodeId); });
+    manager.setSweepWorkers(3);
+    manager.start();
+
+    const int kWriters = 4;
+    const int kRulesPerWriter = 50;
+    std::atomic<bool> writing{true};
+    std::atomic<int> inconsistent{0};
+
+    // 读方：快照中的规则ID集合与规则数一致
+    std::thread reader([&] {
+        while (writing) {
+            std::set<std::string> ids = manager.getManagedRuleIds();
+            if (ids.size() > static_cast<size_t>(kWriters * kRulesPerWriter)) {
+                ++inconsistent;
+            }
+        }
+    });
+    // 上报方：不断标记节点为脏，使检查线程在写入期间持续评估
+    std::thread reporter([&] {
+        int round = 0;
+        while (writing) {
+            for (int n = 0; n < 8; ++n) {
+                cache->updateNodeMetrics("n" + std::to_string(n), MetricSamples{{"cpu", double(round % 100)}});
+            }
+            ++round;
+        }
+    });
+
+    std::vector<std::thread> writers;
+    for (int w = 0; w < kWriters; ++w) {
+        writers.emplace_back([&, w] {
+            for (int i = 0; i < kRulesPerWriter; ++i) {
+                std::string id = "w" + std::to_string(w) + "-" + std::to_string(i);
+                manager.addRule(makeRule(id, "n" + std::to_string(i % 8), cache, 50, nullptr));
+                if (i % 2) {
+                    manager.removeRule(id);
+                }
+            }
+        });
+    }
+    for (auto& writer : writers) writer.join();
+    writing = false;
+    reader.join();
+    reporter.join();
+    manager.stop();
+
+    CHECK(inconsistent == 0);
+    // 每次 addRule / removeRule 各发布一个版本，写入者之间不丢失更新
+    CHECK(manager.getRuleSetVersion() == static_cast<uint64_t>(kWriters * (kRulesPerWriter + kRulesPerWriter / 2)));
+    CHECK(manager.getRuleCount() == static_cast<size_t>(kWriters * kRulesPerWriter / 2));
+    std::set<std::string> ids = manager.getManagedRuleIds();
+    CHECK(ids.count("w0-0") == 1 && ids.count("w3-48") == 1);
+    CHECK(ids.count("w0-1") == 0 && ids.count("w3-49") == 0);
+}
+
+void testNewRuleEvaluated() {
+    auto cache = std::make_shared<MetricCache>(4);
+    AlarmManager manager(cache);
+    cache->setUpdateListener([&manager](const std::string& nodeId) { manager.markNodeDirty(nodeId); });
+    auto action = std::make_shared<RecordingAction>();
+    cache->updateNodeMetrics("n1", MetricSamples{{"cpu", 95}});
+    manager.start();
+
+    // 新规则发布后立即参与下一轮评估，无需等待节点再次上报
+    manager.addRule(makeRule("hot", "n1", cache, 90, action));
+    CHECK(waitFor([&] { return action->ruleIds().size() == 1; }));
+
+    // 替换后的规则从未触发状态开始
+    manager.addRule(makeRule("hot", "n1", cache, 99, action));
+    manager.addRule(makeRule("hot2", "n1", cache, 80, action));
+    CHECK(waitFor([&] { return action->ruleIds().size() == 2; }));
+    manager.stop();
+    CHECK(action->ruleIds().back() == "hot2");
+}
+
+void testStatefulTemplateExpires() {
+    auto cache = std::make_shared<MetricCache>(4);
+    AlarmManager manager(cache);
+    cache->setUpdateListener([&manager](const std::string& nodeId) { manager.markNodeDirty(nodeId); });
+    manager.setFullSweepInterval(std::chrono::seconds(60));
+    manager.setStormAggregation(std::chrono::milliseconds(0), 3); // 迁移立即通知
+    auto fired = std::make_shared<RecordingAction>();
+    auto recovered = std::make_shared<RecordingAction>();
+
+    AlarmRuleTemplate tpl;
+    tpl.templateId = "tpl-window";
+    tpl.metricName = "cpu";
+    tpl.condition = WindowCondition::overDuration(WindowCondition::Aggregate::MAX, std::chrono::seconds(1),
+                                                  std::make_shared<GreaterThanCondition>(90),
+                                                  std::chrono::milliseconds(50));
+    tpl.actions.push_back(fired);
+    tpl.recoveryActions.push_back(recovered);
+    manager.addTemplate(tpl);
+    manager.enrollNodes({cache->internNode("n1")});
+    manager.start();
+
+    for (int i = 0; i < 24 && fired->ruleIds().empty(); ++i) {
+        cache->updateNodeMetrics("n1", MetricSamples{{"cpu", 95}});
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    CHECK(waitFor([&] { return fired->ruleIds().size() == 1; }));
+
+    // 节点停止上报后窗口样本随时间过期，无需等待兜底检查即恢复
+    CHECK(waitFor([&] { return recovered->ruleIds().size() == 1; }));
+    manager.stop();
+    CHECK(fired->ruleIds().size() == 1);
+}
+
+} // namespace
+
+int main() {
+    testVersions();
+    testConcurrentWriters();
+    testNewRuleEvaluated();
+    testStatefulTemplateExpires();
+    return TEST_RESULT();
+}
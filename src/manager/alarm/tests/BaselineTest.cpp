@@ -0,0 +1,122 @@
+// BaselineTest.cpp
+// MetricCache 在线基线：前期按Welford累计、之后按EWMA衰减，预热、最小标准差与截断
+#include "TestUtil.h"
+#include "../MetricCache.h"
+#include <string>
+#include <limits>
+
+namespace {
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+void feed(MetricCache& cache, const std::string& node, double value) {
+    cache.updateNodeMetrics(node, MetricSamples{{"cpu", value}});
+}
+
+double zscore(const MetricCache& cache, const std::string& node) {
+    return cache.getMetric(node, MetricCache::zscoreMetricName("cpu"));
+}
+
+void testWelfordPhase() {
+    MetricCache cache(4);
+    cache.enableBaseline("cpu");   // alpha = 0.05：前20个样本与累计均值/总体方差一致
+    for (int i = 1; i <= 20; ++i) {
+        feed(cache, "n1", i);
+    }
+    MetricCache::Baseline b = cache.getBaseline("n1", "cpu");
+    CHECK(b.count == 20);
+    CHECK_NEAR(b.mean, 10.5, 1e-4);
+    CHECK_NEAR(b.variance, 33.25, 1e-3);
+
+    // 其他节点互不影响；未启用基线的指标 count 为0
+    CHECK(cache.getBaseline("n2", "cpu").count == 0);
+    CHECK(cache.getBaseline("n1", "mem").count == 0);
+}
+
+void testWarmupAndZScore() {
+    MetricCache cache(4);
+    MetricCache::BaselineConfig config;
+    config.warmup = 10;
+    config.clipSigmas = 0;
+    cache.enableBaseline("cpu", config);
+    for (int i = 0; i < 10; ++i) {
+        feed(cache, "n1", i % 2 ? 12 : 8);   // 均值10，标准差2
+        CHECK(std::isnan(zscore(cache, "n1")));
+    }
+    // z分数用并入前的基线计算
+    feed(cache, "n1", 16);
+    CHECK_NEAR(zscore(cache, "n1"), 3.0, 1e-4);
+
+    // NaN样本不更新基线，z分数为NaN
+    uint32_t before = cache.getBaseline("n1", "cpu").count;
+    feed(cache, "n1", kNaN);
+    CHECK(std::isnan(zscore(cache, "n1")));
+    CHECK(cache.getBaseline("n1", "cpu").count == before);
+}
+
+void testMinStdDev() {
+    MetricCache cache(1);
+    MetricCache::BaselineConfig config;
+    config.warmup = 5;
+    config.minStdDev = 0.5;
+    cache.enableBaseline("cpu", config);
+    for (int i = 0; i < 5; ++i) {
+        feed(cache, "n1", 50);
+    }
+    // 平稳序列方差为0，按 minStdDev 计算
+    feed(cache, "n1", 51);
+    CHECK_NEAR(zscore(cache, "n1"), 2.0, 1e-4);
+}
+
+void testClipping() {
+    MetricCache::BaselineConfig config;
+    config.warmup = 10;
+    config.alpha = 0.1;
+    MetricCache clipped(1);
+    MetricCache unclipped(1);
+    clipped.enableBaseline("cpu", config);
+    config.clipSigmas = 0;
+    unclipped.enableBaseline("cpu", config);
+
+    for (int i = 0; i < 10; ++i) {
+        feed(clipped, "n1", i % 2 ? 12 : 8);
+        feed(unclipped, "n1", i % 2 ? 12 : 8);
+    }
+    // 一次极端值：截断后均值最多移动 alpha * 3σ
+    feed(clipped, "n1", 1000);
+    feed(unclipped, "n1", 1000);
+    CHECK(zscore(clipped, "n1") > 100);
+    CHECK(clipped.getBaseline("n1", "cpu").mean <= 10 + 0.1 * 3 * 2 + 1e-4);
+    CHECK(unclipped.getBaseline("n1", "cpu").mean > 90);
+}
+
+void testEwmaTracksLevelShift() {
+    MetricCache cache(1);
+    MetricCache::BaselineConfig config;
+    config.alpha = 0.2;
+    config.warmup = 5;
+    config.clipSigmas = 0;
+    cache.enableBaseline("cpu", config);
+    for (int i = 0; i < 50; ++i) {
+        feed(cache, "n1", 10);
+    }
+    // 预热后按EWMA衰减，旧水平的权重按 (1-alpha)^n 消退
+    for (int i = 0; i < 100; ++i) {
+        feed(cache, "n1", 100);
+    }
+    MetricCache::Baseline b = cache.getBaseline("n1", "cpu");
+    CHECK_NEAR(b.mean, 100, 1e-2);
+    CHECK(b.variance < 1e-2);
+    CHECK(b.count == 150);
+}
+
+} // namespace
+
+int main() {
+    testWelfordPhase();
+    testWarmupAndZScore();
+    testMinStdDev();
+    testClipping();
+    testEwmaTracksLevelShift();
+    return TEST_RESULT();
+}
@@ -0,0 +1,145 @@
+// ConditionProgramTest.cpp
+// 条件树编译为区间集合后，求值结果须与原有的虚函数求值逐值一致，包括NaN、±inf与阈值边界
+#include "TestUtil.h"
+#include "../ConditionProgram.h"
+#include "../GreaterThanCondition.h"
+#include "../LessThanCondition.h"
+#include "../AndCondition.h"
+#include "../OrCondition.h"
+#include "../NotCondition.h"
+#include <vector>
+#include <memory>
+#include <limits>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+using Condition = std::shared_ptr<IAlarmCondition>;
+
+const double kInf = std::numeric_limits<double>::infinity();
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+Condition gt(double t) { return std::make_shared<GreaterThanCondition>(t); }
+Condition lt(double t) { return std::make_shared<LessThanCondition>(t); }
+Condition all(std::vector<Condition> c) { return std::make_shared<AndCondition>(std::move(c)); }
+Condition any(std::vector<Condition> c) { return std::make_shared<OrCondition>(std::move(c)); }
+Condition negate(Condition c) { return std::make_shared<NotCondition>(std::move(c)); }
+
+// 无法展开为区间的条件，用于检查回退路径
+class EvenCondition : public IAlarmCondition {
+public:
+    bool isTriggered(double value) const override { return std::fmod(value, 2.0) == 0.0; }
+    std::string getDescription() const override { return "is even"; }
+};
+
+// 阈值本身、两侧最近的可表示值、0、±inf 与 NaN
+std::vector<double> probeValues(const std::vector<double>& thresholds) {
+    std::vector<double> values = {kNaN, kInf, -kInf, 0.0, -0.0, 1e300, -1e300};
+    for (double t : thresholds) {
+        values.push_back(t);
+        values.push_back(std::nextafter(t, kInf));
+        values.push_back(std::nextafter(t, -kInf));
+    }
+    return values;
+}
+
+void checkMatchesVirtual(const Condition& condition, const std::vector<double>& thresholds) {
+    ConditionProgram program = ConditionProgram::compile(condition);
+    CHECK(program.isCompiled());
+
+    // 重复探测值使批量求值跨过256个元素的分块边界
+    std::vector<double> probes = probeValues(thresholds);
+    std::vector<double> values;
+    while (values.size() < 600) {
+        values.insert(values.end(), probes.begin(), probes.end());
+    }
+    std::vector<uint8_t> batch(values.size());
+    program.evaluateBatch(values.data(), values.size(), batch.data());
+
+    for (size_t i = 0; i < values.size(); ++i) {
+        const bool expected = condition->isTriggered(values[i]);
+        if (program.evaluate(values[i]) != expected || (batch[i] != 0) != expected) {
+            test::fail(__FILE__, __LINE__, condition->getDescription() + " disagrees at value " +
+                                           std::to_string(values[i]));
+            return;
+        }
+    }
+}
+
+void testThresholds() {
+    checkMatchesVirtual(gt(90), {90});
+    checkMatchesVirtual(lt(10), {10});
+    checkMatchesVirtual(gt(-kInf), {0});
+    checkMatchesVirtual(lt(kInf), {0});
+}
+
+void testCompoundTrees() {
+    checkMatchesVirtual(all({gt(80), lt(95)}), {80, 95});
+    checkMatchesVirtual(any({lt(10), gt(90)}), {10, 90});
+    checkMatchesVirtual(any({gt(50), gt(20), lt(30)}), {20, 30, 50});
+    checkMatchesVirtual(all({gt(90), lt(10)}), {10, 90});   // 空集
+    checkMatchesVirtual(all({}), {0});                      // AND 的单位元：全集
+    checkMatchesVirtual(any({}), {0});                      // OR 的单位元：空集
+}
+
+void testNegation() {
+    // NOT 使NaN进入集合：!(NaN > 90) 为真
+    checkMatchesVirtual(negate(gt(90)), {90});
+    checkMatchesVirtual(negate(all({gt(80), lt(95)})), {80, 95});
+    checkMatchesVirtual(negate(negate(gt(50))), {50});
+    checkMatchesVirtual(any({gt(50), negate(gt(50))}), {50});
+    checkMatchesVirtual(all({negate(lt(10)), negate(gt(90))}), {10, 90});
+}
+
+void testIntervalSet() {
+    IntervalSet above = IntervalSet::greaterThan(90);
+    CHECK(!above.containsNaN());
+    CHECK(above.intervals().size() == 1);
+
+    // 补集：[-inf, 90] 外加NaN
+    IntervalSet rest = above.complement();
+    CHECK(rest.containsNaN());
+    CHECK(rest.intervals().size() == 1);
+    CHECK(rest.intervals()[0].lo == -kInf && rest.intervals()[0].loClosed);
+    CHECK(rest.intervals()[0].hi == 90 && rest.intervals()[0].hiClosed);
+
+    // 相接的区间合并为一个
+    IntervalSet joined = IntervalSet::lessThan(10).unite(IntervalSet::lessThan(10).complement());
+    CHECK(joined.intervals().size() == 1);
+    CHECK(joined.containsNaN());
+
+    CHECK(IntervalSet::greaterThan(90).intersect(IntervalSet::lessThan(10)).intervals().empty());
+    CHECK(IntervalSet::all().complement().intervals().empty());
+    CHECK(!IntervalSet::all().complement().containsNaN());
+}
+
+void testFallback() {
+    Condition even = std::make_shared<EvenCondition>();
+    ConditionProgram program = ConditionProgram::compile(all({gt(0), even}));
+    CHECK(!program.isCompiled());
+    CHECK(program.evaluate(4));
+    CHECK(!program.evaluate(3));
+    CHECK(!program.evaluate(-4));
+
+    double values[] = {2, 3, -2, kNaN};
+    uint8_t out[4];
+    program.evaluateBatch(values, 4, out);
+    CHECK(out[0] == 1 && out[1] == 0 && out[2] == 0 && out[3] == 0);
+
+    // 空条件恒为假
+    ConditionProgram none = ConditionProgram::compile(nullptr);
+    CHECK(none.isCompiled());
+    CHECK(!none.evaluate(100));
+}
+
+} // namespace
+
+int main() {
+    testThresholds();
+    testCompoundTrees();
+    testNegation();
+    testIntervalSet();
+    testFallback();
+    return TEST_RESULT();
+}
@@ -0,0 +1,177 @@
+// ExpressionProgramTest.cpp
+// 表达式解析、类型检查与两种求值路径（标量/列式）
+#include "TestUtil.h"
+#include "../ExpressionProgram.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+// 按名称给出指标值，未给出的指标视为缺失（NaN）
+double eval(const std::string& source, const std::map<std::string, double>& metrics) {
+    MetricCache cache(1);
+    ExpressionProgram program = ExpressionProgram::compile(source, cache);
+    std::map<MetricCache::MetricId, double> byId;
+    for (const auto& m : metrics) {
+        byId[cache.internMetric(m.first)] = m.second;
+    }
+    return program.evaluate([&](MetricCache::MetricId id) {
+        auto it = byId.find(id);
+        return it == byId.end() ? kNaN : it->second;
+    });
+}
+
+double eval(const std::string& source) {
+    return eval(source, {});
+}
+
+ExpressionProgram::Type typeOf(const std::string& source) {
+    MetricCache cache(1);
+    return ExpressionProgram::compile(source, cache).getType();
+}
+
+void rejects(const std::string& source) {
+    MetricCache cache(1);
+    bool thrown = false;
+    try {
+        ExpressionProgram::compile(source, cache);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    if (!thrown) test::fail(__FILE__, __LINE__, "expected compile error for: " + source);
+}
+
+void testArithmetic() {
+    CHECK(eval("1 + 2 * 3") == 7);
+    CHECK(eval("(1 + 2) * 3") == 9);
+    CHECK(eval("10 - 4 - 3") == 3);       // 左结合
+    CHECK(eval("8 / 4 / 2") == 1);
+    CHECK(eval("-2 * -3") == 6);
+    CHECK(eval("2.5e1 + .5") == 25.5);
+    CHECK(eval("abs(-3) + min(4, 2, 8) + max(1, 5)") == 10);
+    CHECK(eval("memory_used / memory_total", {{"memory_used", 3}, {"memory_total", 4}}) == 0.75);
+}
+
+void testLogic() {
+    CHECK(eval("1 < 2 && 2 < 3") == 1);
+    CHECK(eval("1 > 2 || 2 < 3") == 1);
+    CHECK(eval("!(1 > 2)") == 1);
+    CHECK(eval("1 != 2") == 1);
+    CHECK(eval("2 >= 2 and 2 <= 2") == 1);
+    CHECK(eval("1 > 2 or not 1 > 2") == 1);
+    // && 优先于 ||
+    CHECK(eval("1 > 0 || 1 > 2 && 1 > 2") == 1);
+    // 关键字须是完整单词，nothing / orders 是指标名
+    CHECK(eval("nothing + orders", {{"nothing", 1}, {"orders", 2}}) == 3);
+}
+
+void testTypes() {
+    CHECK(typeOf("cpu + 1") == ExpressionProgram::Type::NUMBER);
+    CHECK(typeOf("cpu > 1") == ExpressionProgram::Type::BOOLEAN);
+    CHECK(typeOf("!(cpu > 1)") == ExpressionProgram::Type::BOOLEAN);
+
+    rejects("cpu > 1 + (mem > 2)");   // 布尔参与算术
+    rejects("cpu && mem > 1");        // 数值参与逻辑运算
+    rejects("!cpu");
+    rejects("(cpu > 1) > 0");         // 布尔参与比较
+    rejects("abs(cpu > 1)");
+}
+
+void testSyntaxErrors() {
+    rejects("");
+    rejects("1 +");
+    rejects("(1 + 2");
+    rejects("1 + 2)");
+    rejects("cpu > 1 > 0");
+    rejects("foo(1)");
+    rejects("abs(1, 2)");
+    rejects("min(1)");
+    rejects("cpu $ 1");
+
+    // 嵌套超过栈深度上限
+    std::string deep;
+    for (int i = 0; i < 70; ++i) deep += "(1 + ";
+    deep += "1";
+    for (int i = 0; i < 70; ++i) deep += ")";
+    rejects(deep);
+
+    // 病态的深层嵌套在解析阶段报错，而不是耗尽调用栈
+    for (const std::string unit : {"(", "!", "-", "abs(", "!("}) {
+        std::string source;
+        for (int i = 0; i < 100000; ++i) source += unit;
+        rejects(source + "1 > 0");
+    }
+    // 上限以内的嵌套照常编译
+    std::string nested;
+    for (int i = 0; i < 30; ++i) nested += "!(";
+    nested += "1 > 0";
+    for (int i = 0; i < 30; ++i) nested += ")";
+    CHECK(eval(nested) == 1);
+}
+
+void testMissingMetrics() {
+    // 缺失指标沿所有运算传播，结果为NaN，模板按未触发处理
+    for (const char* source : {"cpu > 1", "cpu < 1", "cpu == 1", "cpu != 1", "cpu != cpu", "cpu + 1",
+                               "!(cpu > 1)", "not not (cpu > 1)", "max(cpu, 3)", "min(3, cpu)",
+                               "cpu > 1 && 1 > 0", "1 > 0 || cpu > 1", "abs(-cpu)"}) {
+        CHECK(std::isnan(eval(source)));
+    }
+    CHECK(eval("!(cpu > 1)", {{"cpu", 0}}) == 1);
+    CHECK(eval("max(cpu, 3)", {{"cpu", 5}}) == 5);
+}
+
+void testBatchMatchesScalar() {
+    MetricCache cache(1);
+    const size_t kNodes = 600;   // 跨过256个节点的分块边界
+    for (size_t i = 0; i < kNodes; ++i) {
+        MetricSamples samples = {{"used", static_cast<double>(i % 13)}, {"total", 10.0}};
+        if (i % 7 != 0) {
+            samples.emplace_back("load", static_cast<double>(i % 5));
+        }
+        cache.updateNodeMetrics("node-" + std::to_string(i), samples);
+    }
+
+    const std::vector<std::string> sources = {
+        "used / total > 0.9 && load > 2",
+        "used / total > 0.9 || !(load != 3)",
+        "max(used, load) - min(used, total) * 2",
+        "abs(load - used) >= 4 or used == 0",
+        "missing_metric > 1 || used > 5",
+    };
+    for (const auto& source : sources) {
+        ExpressionProgram program = ExpressionProgram::compile(source, cache);
+        cache.readShard(0, [&](const MetricCache::ShardView& view) {
+            const size_t count = view.nodeCount();
+            CHECK(count == kNodes);
+            std::vector<double> batch(count);
+            program.evaluateBatch(view, count, batch.data());
+            for (size_t i = 0; i < count; ++i) {
+                double scalar = program.evaluate([&](MetricCache::MetricId id) {
+                    const double* column = view.column(id);
+                    return column ? column[i] : kNaN;
+                });
+                if (!test::sameValue(batch[i], scalar)) {
+                    test::fail(__FILE__, __LINE__, source + " differs at node " + std::to_string(i));
+                    break;
+                }
+            }
+        });
+    }
+}
+
+} // namespace
+
+int main() {
+    testArithmetic();
+    testLogic();
+    testTypes();
+    testSyntaxErrors();
+    testMissingMetrics();
+    testBatchMatchesScalar();
+    return TEST_RESULT();
+}
@@ -0,0 +1,155 @@
+// MetricCacheTest.cpp
+// 分片锁下的并发读写：多个写线程各自更新一批节点，读线程同时按名称、按下标与按分片读取
+#include "TestUtil.h"
+#include "../MetricCache.h"
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const size_t kWriters = 4;
+const size_t kNodesPerWriter = 50;
+const int kRounds = 200;
+
+std::string nodeName(size_t writer, size_t i) {
+    return "node-" + std::to_string(writer) + "-" + std::to_string(i);
+}
+
+void testInterning() {
+    MetricCache cache(8);
+    MetricCache::MetricId cpu = cache.internMetric("cpu");
+    CHECK(cache.internMetric("cpu") == cpu);
+    CHECK(cache.internMetric("mem") != cpu);
+
+    MetricCache::NodeIndex node = cache.internNode("host-a");
+    CHECK(cache.internNode("host-a") == node);
+    CHECK(cache.getNodeId(node) == "host-a");
+    CHECK(cache.shardOfIndex(node) == cache.shardOfNode("host-a"));
+    CHECK(cache.makeNodeIndex(cache.shardOfIndex(node), cache.localOfIndex(node)) == node);
+
+    // 驻留但从未上报的节点没有数据
+    CHECK(std::isnan(cache.getMetric(node, cpu)));
+    CHECK(std::isnan(cache.getMetric("host-a", "cpu")));
+    CHECK(std::isnan(cache.getMetric("unknown", "cpu")));
+    CHECK(cache.getActiveNodeIds().empty());
+
+    cache.updateNodeMetrics("host-a", MetricSamples{{"cpu", 42}});
+    CHECK(cache.getMetric(node, cpu) == 42);
+    CHECK(cache.getMetric("host-a", "cpu") == 42);
+    CHECK(std::isnan(cache.getMetric("host-a", "mem")));
+    CHECK(cache.getActiveNodeIds() == std::set<std::string>{"host-a"});
+
+    // JSON 快照只取数值字段
+    cache.updateNodeMetrics("host-a", json{{"cpu", 7}, {"name", "x"}, {"mem", 1.5}});
+    CHECK(cache.getMetric("host-a", "cpu") == 7);
+    CHECK(cache.getMetric("host-a", "mem") == 1.5);
+    CHECK(std::isnan(cache.getMetric("host-a", "name")));
+}
+
+void testConcurrentReadWrite() {
+    MetricCache cache(8);
+    std::mutex eventsMutex;
+    std::map<std::string, int> joined;
+    cache.setMembershipListener([&](MetricCache::NodeIndex, const std::string& nodeId, MetricCache::NodeEvent event) {
+        std::lock_guard<std::mutex> lock(eventsMutex);
+        joined[nodeId] += event == MetricCache::NodeEvent::JOINED ? 1 : -1;
+    });
+
+    const MetricCache::MetricId metricA = cache.internMetric("a");
+    const MetricCache::MetricId metricB = cache.internMetric("b");
+    std::atomic<bool> writing{true};
+    std::atomic<size_t> torn{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&] {
+            while (writing) {
+                // 同一次写入的两个指标在分片锁内一起更新，读方不应看到一半
+                for (size_t shardNo = 0; shardNo < cache.getShardCount(); ++shardNo) {
+                    cache.readShard(shardNo, [&](const MetricCache::ShardView& view) {
+                        const double* a = view.column(metricA);
+                        const double* b = view.column(metricB);
+                        if (!a || !b) return;
+                        for (size_t i = 0; i < view.nodeCount(); ++i) {
+                            if (!(std::isnan(a[i]) && std::isnan(b[i])) && b[i] != -a[i]) {
+                                ++torn;
+                            }
+                        }
+                    });
+                }
+                cache.getActiveNodeIds();
+            }
+        });
+    }
+
+    std::vector<std::thread> writers;
+    for (size_t w = 0; w < kWriters; ++w) {
+        writers.emplace_back([&cache, w] {
+            for (int round = 1; round <= kRounds; ++round) {
+                for (size_t i = 0; i < kNodesPerWriter; ++i) {
+                    double value = round * 1000.0 + static_cast<double>(i);
+                    cache.updateNodeMetrics(nodeName(w, i), MetricSamples{{"a", value}, {"b", -value}});
+                }
+            }
+        });
+    }
+    for (auto& writer : writers) writer.join();
+    writing = false;
+    for (auto& reader : readers) reader.join();
+
+    CHECK(torn == 0);
+    for (size_t w = 0; w < kWriters; ++w) {
+        for (size_t i = 0; i < kNodesPerWriter; ++i) {
+            CHECK(cache.getMetric(nodeName(w, i), "a") == kRounds * 1000.0 + static_cast<double>(i));
+        }
+    }
+    CHECK(cache.getActiveNodeIds().size() == kWriters * kNodesPerWriter);
+    CHECK(cache.getActiveNodeIndices().size() == kWriters * kNodesPerWriter);
+
+    // 每个节点只在首次上报时 JOINED 一次
+    CHECK(joined.size() == kWriters * kNodesPerWriter);
+    for (const auto& pair : joined) {
+        CHECK(pair.second == 1);
+    }
+
+    // 节点分布到所有分片，每次写入各计一次加锁
+    json stats = cache.getStats();
+    CHECK(stats["nodes"] == kWriters * kNodesPerWriter);
+    for (const auto& shard : stats["shards"]) {
+        CHECK(shard["nodes"].get<size_t>() > 0);
+    }
+    CHECK(cache.getContentionStats().acquisitions >= kWriters * kNodesPerWriter * kRounds);
+    CHECK(cache.getContentionStats().contended <= cache.getContentionStats().acquisitions);
+}
+
+void testExpiry() {
+    MetricCache cache(4);
+    std::vector<std::pair<std::string, MetricCache::NodeEvent>> events;
+    cache.setMembershipListener([&](MetricCache::NodeIndex, const std::string& nodeId, MetricCache::NodeEvent event) {
+        events.emplace_back(nodeId, event);
+    });
+    cache.updateNodeMetrics("n1", MetricSamples{{"cpu", 1}});
+    cache.updateNodeMetrics("n2", MetricSamples{{"cpu", 1}});
+    CHECK(cache.expireInactiveNodes(std::chrono::seconds(60)) == 0);
+    CHECK(cache.expireInactiveNodes(std::chrono::seconds(0)) == 2);
+    // 已过期的节点不重复发出 EXPIRED
+    CHECK(cache.expireInactiveNodes(std::chrono::seconds(0)) == 0);
+    // 过期后重新上报再次 JOINED，数据保留
+    cache.updateNodeMetrics("n1", MetricSamples{{"cpu", 2}});
+    CHECK(events.size() == 5);
+    CHECK(events.back().first == "n1" && events.back().second == MetricCache::NodeEvent::JOINED);
+    CHECK(cache.getMetric("n2", "cpu") == 1);
+}
+
+} // namespace
+
+int main() {
+    testInterning();
+    testConcurrentReadWrite();
+    testExpiry();
+    return TEST_RESULT();
+}
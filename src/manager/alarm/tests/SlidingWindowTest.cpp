@@ -0,0 +1,211 @@
+// SlidingWindowTest.cpp
+// 单调队列维护的最大/最小值、增量维护的和与分位数须与对窗口内容直接计算的结果一致
+#include "TestUtil.h"
+#include "../SlidingWindow.h"
+#include "../WindowCondition.h"
+#include "../ConsecutiveCondition.h"
+#include "../GreaterThanCondition.h"
+#include <vector>
+#include <deque>
+#include <random>
+#include <limits>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using std::chrono::seconds;
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+// 按定义保存窗口内容的参照实现
+struct ReferenceWindow {
+    size_t capacity;
+    std::deque<std::pair<double, Clock::time_point>> samples;
+
+    void push(double value, Clock::time_point ts) {
+        if (std::isnan(value)) return;
+        if (samples.size() == capacity) samples.pop_front();
+        samples.emplace_back(value, ts);
+    }
+    void expireBefore(Clock::time_point cutoff) {
+        while (!samples.empty() && samples.front().second < cutoff) samples.pop_front();
+    }
+    std::vector<double> values() const {
+        std::vector<double> v;
+        for (const auto& s : samples) v.push_back(s.first);
+        return v;
+    }
+};
+
+void checkAgainstReference(const SlidingWindow& window, const ReferenceWindow& reference) {
+    std::vector<double> v = reference.values();
+    CHECK(window.size() == v.size());
+    if (v.empty()) {
+        CHECK(std::isnan(window.max()) && std::isnan(window.min()) && std::isnan(window.average()));
+        return;
+    }
+    CHECK(window.max() == *std::max_element(v.begin(), v.end()));
+    CHECK(window.min() == *std::min_element(v.begin(), v.end()));
+    CHECK_NEAR(window.sum(), std::accumulate(v.begin(), v.end(), 0.0), 1e-6);
+}
+
+void testMonotonicQueues() {
+    // 容量很小、序列很长，单调队列与样本环反复绕回；包含重复值与单调段
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(0, 20);
+    for (size_t capacity : {1u, 2u, 7u, 64u}) {
+        SlidingWindow window(capacity, true, true);
+        ReferenceWindow reference{capacity, {}};
+        auto t = Clock::now();
+        for (int i = 0; i < 2000; ++i) {
+            double value = i % 97 < 10 ? i % 97 : dist(rng);  // 夹杂一段递增序列
+            window.push(value, t);
+            reference.push(value, t);
+            checkAgainstReference(window, reference);
+            t += seconds(1);
+        }
+    }
+}
+
+void testExpiry() {
+    SlidingWindow window(16, true, true);
+    ReferenceWindow reference{16, {}};
+    auto t0 = Clock::now();
+    for (int i = 0; i < 10; ++i) {
+        window.push(10 - i, t0 + seconds(i));
+        reference.push(10 - i, t0 + seconds(i));
+    }
+    // 淘汰时间戳早于 t0+4 的样本，最大值随之由队首出队
+    window.expireBefore(t0 + seconds(4));
+    reference.expireBefore(t0 + seconds(4));
+    checkAgainstReference(window, reference);
+    CHECK(window.max() == 6);
+
+    window.expireBefore(t0 + seconds(100));
+    reference.expireBefore(t0 + seconds(100));
+    checkAgainstReference(window, reference);
+    CHECK(window.size() == 0);
+
+    // 清空后重新填充
+    window.push(3, t0 + seconds(101));
+    reference.push(3, t0 + seconds(101));
+    checkAgainstReference(window, reference);
+}
+
+void testNaNAndSum() {
+    SlidingWindow window(4, false, false);
+    auto t = Clock::now();
+    window.push(kNaN, t);
+    CHECK(window.size() == 0);
+    CHECK(std::isnan(window.average()));
+    // 未跟踪最大/最小值时返回NaN
+    window.push(1, t);
+    CHECK(std::isnan(window.max()));
+
+    // 大小悬殊的数值反复进出，绕环重算后和不应漂移
+    for (int i = 0; i < 10000; ++i) {
+        window.push(i % 2 ? 1e12 : 1.0, t);
+    }
+    CHECK_NEAR(window.sum(), 2e12 + 2.0, 1e-3);
+    CHECK_NEAR(window.average(), (2e12 + 2.0) / 4, 1e-3);
+}
+
+void testPercentile() {
+    SlidingWindow window(100, false, false);
+    auto t = Clock::now();
+    for (int i = 100; i >= 1; --i) {
+        window.push(i, t);
+    }
+    // 最近秩法：rank = ceil(p * n)
+    CHECK(window.percentile(0.95) == 95);
+    CHECK(window.percentile(0.5) == 50);
+    CHECK(window.percentile(1.0) == 100);
+    CHECK(window.percentile(0.001) == 1);
+}
+
+void testDurationWindowCoversDuration() {
+    // 5分钟、1秒一个样本：最旧的高值样本仍在窗口内时须触发
+    auto condition = WindowCondition::overDuration(WindowCondition::Aggregate::MAX, seconds(300),
+                                                   std::make_shared<GreaterThanCondition>(90));
+    auto state = condition->createState();
+    auto t0 = Clock::now();
+    condition->addSample(*state, 99, t0);
+    for (int i = 1; i <= 300; ++i) {
+        condition->addSample(*state, 10, t0 + seconds(i));
+    }
+    CHECK(condition->isStateTriggered(*state, t0 + seconds(300)));
+    // 高值样本超出时长后不再触发
+    CHECK(!condition->isStateTriggered(*state, t0 + seconds(301)));
+}
+
+void testDurationWindowNeedsCoverage() {
+    // 60秒均值：第一个样本不能单独决定结果，样本覆盖时长的 kMinCoverage 之后才判断
+    auto condition = WindowCondition::overDuration(WindowCondition::Aggregate::AVG, seconds(60),
+                                                   std::make_shared<GreaterThanCondition>(90));
+    auto state = condition->createState();
+    auto t0 = Clock::now();
+    condition->addSample(*state, 99, t0);
+    CHECK(!condition->isStateTriggered(*state, t0));
+    for (int i = 1; i < 48; ++i) {
+        condition->addSample(*state, 99, t0 + seconds(i));
+    }
+    CHECK(!condition->isStateTriggered(*state, t0 + seconds(47)));
+    condition->addSample(*state, 99, t0 + seconds(48));
+    CHECK(condition->isStateTriggered(*state, t0 + seconds(48)));
+
+    // 上报中断后旧样本过期，恢复上报须重新积累
+    auto resumed = t0 + seconds(200);
+    condition->addSample(*state, 99, resumed);
+    CHECK(!condition->isStateTriggered(*state, resumed));
+
+    // 容量被 kMaxCapacity 截断时按容量对应的时长要求覆盖，窗口已满即可判断
+    auto capped = WindowCondition::overDuration(WindowCondition::Aggregate::MAX, seconds(100),
+                                                std::make_shared<GreaterThanCondition>(90),
+                                                std::chrono::milliseconds(1));
+    auto cappedState = capped->createState();
+    for (size_t i = 0; i < WindowCondition::kMaxCapacity; ++i) {
+        capped->addSample(*cappedState, 95, t0 + std::chrono::milliseconds(i));
+    }
+    CHECK(capped->isStateTriggered(*cappedState, t0 + std::chrono::milliseconds(WindowCondition::kMaxCapacity)));
+}
+
+void testSampleWindowAndConsecutive() {
+    auto t = Clock::now();
+    // 按样本数的窗口填满前不触发
+    auto avg = WindowCondition::overSamples(WindowCondition::Aggregate::AVG, 3,
+                                            std::make_shared<GreaterThanCondition>(90));
+    auto state = avg->createState();
+    avg->addSample(*state, 100, t);
+    avg->addSample(*state, 100, t);
+    CHECK(!avg->isStateTriggered(*state, t));
+    avg->addSample(*state, 100, t);
+    CHECK(avg->isStateTriggered(*state, t));
+    avg->addSample(*state, 0, t);   // (100 + 100 + 0) / 3 < 90
+    CHECK(!avg->isStateTriggered(*state, t));
+
+    // 连续N次：中间一次不满足即重新计数
+    ConsecutiveCondition consecutive(std::make_shared<GreaterThanCondition>(90), 3);
+    auto streak = consecutive.createState();
+    for (double v : {95.0, 95.0, 50.0, 95.0, 95.0}) {
+        consecutive.addSample(*streak, v, t);
+    }
+    CHECK(!consecutive.isStateTriggered(*streak, t));
+    consecutive.addSample(*streak, 95, t);
+    CHECK(consecutive.isStateTriggered(*streak, t));
+}
+
+} // namespace
+
+int main() {
+    testMonotonicQueues();
+    testExpiry();
+    testNaNAndSum();
+    testPercentile();
+    testDurationWindowCoversDuration();
+    testDurationWindowNeedsCoverage();
+    testSampleWindowAndConsecutive();
+    return TEST_RESULT();
+}
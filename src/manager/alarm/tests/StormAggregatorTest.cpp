@@ -0,0 +1,164 @@
+// StormAggregatorTest.cpp
+// 告警风暴聚合：窗口期限、按方向合并、成员不足时逐条发出、窗口内往返相互抵消，
+// 以及经 AlarmManager 的检查线程端到端聚合模板迁移
+#include "TestUtil.h"
+#include "../StormAggregator.h"
+#include "../AlarmManager.h"
+#include "../GreaterThanCondition.h"
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using std::chrono::milliseconds;
+
+std::shared_ptr<const AlarmRuleTemplate> makeTemplate(const std::string& id) {
+    auto tpl = std::make_shared<AlarmRuleTemplate>();
+    tpl->templateId = id;
+    tpl->metricName = "cpu";
+    return tpl;
+}
+
+void testWindow() {
+    StormAggregator aggregator(milliseconds(100), 3);
+    CHECK(aggregator.enabled());
+    auto tpl = makeTemplate("t");
+    auto t0 = StormAggregator::TimePoint();
+    StormAggregator::TimePoint deadline;
+    CHECK(!aggregator.nextDeadline(deadline));
+
+    // 窗口由第一个迁移打开，之后的迁移不延长窗口
+    aggregator.add(tpl, "n1", true, t0);
+    aggregator.add(tpl, "n2", true, t0 + milliseconds(50));
+    aggregator.add(tpl, "n3", true, t0 + milliseconds(90));
+    CHECK(aggregator.nextDeadline(deadline) && deadline == t0 + milliseconds(100));
+
+    std::vector<AlarmNotification> out;
+    aggregator.flush(t0 + milliseconds(99), false, out);
+    CHECK(out.empty());
+    aggregator.flush(t0 + milliseconds(100), false, out);
+    CHECK(out.size() == 1);
+    if (out.size() == 1) {
+        CHECK(out[0].triggered);
+        CHECK(out[0].members == (std::vector<std::string>{"n1", "n2", "n3"}));
+    }
+    CHECK(!aggregator.nextDeadline(deadline));
+}
+
+void testDirectionsAndSmallGroups() {
+    StormAggregator aggregator(milliseconds(100), 3);
+    auto a = makeTemplate("a");
+    auto b = makeTemplate("b");
+    auto t0 = StormAggregator::TimePoint();
+    for (const char* node : {"n1", "n2", "n3", "n4"}) {
+        aggregator.add(a, node, true, t0);
+    }
+    aggregator.add(a, "n5", false, t0);
+    aggregator.add(a, "n6", false, t0);
+    // 另一个模板各自开窗
+    aggregator.add(b, "n1", true, t0 + milliseconds(30));
+
+    std::vector<AlarmNotification> out;
+    aggregator.flush(t0 + milliseconds(100), false, out);
+    // 触发的4个合并为一条；恢复的2个少于 minGroupSize，逐条发出；模板 b 尚未到期
+    CHECK(out.size() == 3);
+    if (out.size() == 3) {
+        CHECK(out[0].triggered && out[0].members.size() == 4);
+        CHECK(!out[1].triggered && out[1].members == std::vector<std::string>{"n5"});
+        CHECK(!out[2].triggered && out[2].members == std::vector<std::string>{"n6"});
+    }
+    out.clear();
+    aggregator.flush(t0 + milliseconds(100), true, out);
+    CHECK(out.size() == 1 && out[0].tpl->templateId == "b");
+}
+
+void testRoundTripCancels() {
+    StormAggregator aggregator(milliseconds(100), 2);
+    auto tpl = makeTemplate("t");
+    auto t0 = StormAggregator::TimePoint();
+    aggregator.add(tpl, "n1", true, t0);
+    aggregator.add(tpl, "n1", false, t0 + milliseconds(10));
+    aggregator.add(tpl, "n2", true, t0 + milliseconds(10));
+    std::vector<AlarmNotification> out;
+    aggregator.flush(t0 + milliseconds(100), false, out);
+    CHECK(out.size() == 1 && out[0].members == std::vector<std::string>{"n2"});
+
+    // 窗口为0时不聚合
+    aggregator.configure(milliseconds(0), 3);
+    CHECK(!aggregator.enabled());
+}
+
+class RecordingAction : public IAlarmAction {
+public:
+    void execute(const std::string& ruleId, const std::string& resourceName) override {
+        executeBatch({AlarmActionEvent{ruleId, resourceName, std::chrono::system_clock::now(), {}}});
+    }
+
+    void executeBatch(const std::vector<AlarmActionEvent>& events) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        events_.insert(events_.end(), events.begin(), events.end());
+    }
+
+    std::vector<AlarmActionEvent> events() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return events_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<AlarmActionEvent> events_;
+};
+
+void testThroughManager() {
+    auto cache = std::make_shared<MetricCache>(4);
+    AlarmManager manager(cache);
+    cache->setUpdateListener([&manager](const std::string& nodeId) { manager.markNodeDirty(nodeId); });
+    manager.setStormAggregation(milliseconds(200), 3);
+    manager.setSweepWorkers(2);
+
+    auto action = std::make_shared<RecordingAction>();
+    AlarmRuleTemplate tpl;
+    tpl.templateId = "tpl-cpu";
+    tpl.metricName = "cpu";
+    tpl.condition = std::make_shared<GreaterThanCondition>(90);
+    tpl.actions.push_back(action);
+    manager.addTemplate(tpl);
+
+    std::vector<MetricCache::NodeIndex> nodes;
+    for (int i = 0; i < 6; ++i) {
+        nodes.push_back(cache->internNode("n" + std::to_string(i)));
+    }
+    manager.enrollNodes(nodes);
+    manager.start();
+
+    // 5个节点在一个窗口内先后越限，合并为一条聚合通知；另一个节点正常
+    for (int i = 0; i < 6; ++i) {
+        cache->updateNodeMetrics("n" + std::to_string(i), MetricSamples{{"cpu", i == 5 ? 10.0 : 95.0}});
+        std::this_thread::sleep_for(milliseconds(10));
+    }
+    std::this_thread::sleep_for(milliseconds(500));
+    manager.stop();
+
+    std::vector<AlarmActionEvent> events = action->events();
+    CHECK(events.size() == 1);
+    if (events.size() == 1) {
+        CHECK(events[0].ruleId == "tpl-cpu:*");
+        std::vector<std::string> members = events[0].members;
+        std::sort(members.begin(), members.end());
+        CHECK(members == (std::vector<std::string>{"n0", "n1", "n2", "n3", "n4"}));
+    }
+}
+
+} // namespace
+
+int main() {
+    testWindow();
+    testDirectionsAndSmallGroups();
+    testRoundTripCancels();
+    testThroughManager();
+    return TEST_RESULT();
+}
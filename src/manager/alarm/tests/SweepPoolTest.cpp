@@ -0,0 +1,82 @@
+// SweepPoolTest.cpp
+// 评估线程池：每轮每个任务恰好执行一次，run 返回时所有任务都已结束；
+// 调整线程数（包括在若干轮之后）不影响之后的轮次
+#include "TestUtil.h"
+#include "../SweepPool.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 执行若干轮，检查每轮的任务计数与 run 返回时没有仍在执行的任务
+void runRounds(SweepPool& pool, int rounds, size_t tasks) {
+    std::vector<std::atomic<int>> counts(tasks);
+    std::atomic<int> active{0};
+    for (int round = 0; round < rounds; ++round) {
+        for (auto& count : counts) count = 0;
+        pool.run(tasks, [&](size_t index) {
+            ++active;
+            if (index % 3 == 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            ++counts[index];
+            --active;
+        });
+        if (active != 0) {
+            test::fail(__FILE__, __LINE__, "run returned while a task was still running");
+            return;
+        }
+        for (size_t i = 0; i < tasks; ++i) {
+            if (counts[i] != 1) {
+                test::fail(__FILE__, __LINE__, "task " + std::to_string(i) + " ran " +
+                                               std::to_string(counts[i].load()) + " times");
+                return;
+            }
+        }
+    }
+}
+
+void testSequential() {
+    SweepPool pool(0);
+    CHECK(pool.size() == 0);
+    runRounds(pool, 5, 8);
+}
+
+void testParallel() {
+    SweepPool pool(3);
+    CHECK(pool.size() == 3);
+    runRounds(pool, 200, 16);
+    // 任务数不超过1时在调用线程上执行
+    runRounds(pool, 10, 1);
+}
+
+void testResizeAfterRuns() {
+    // 先执行若干轮再增加线程：新线程不得把已结束的轮次当作新一轮
+    SweepPool pool(1);
+    runRounds(pool, 20, 8);
+    pool.resize(4);
+    CHECK(pool.size() == 4);
+    runRounds(pool, 200, 16);
+    pool.resize(2);
+    runRounds(pool, 200, 16);
+    pool.resize(0);
+    runRounds(pool, 5, 16);
+    pool.resize(3);
+    runRounds(pool, 200, 16);
+    // 新线程启动与紧随其后的 run 交错
+    for (int i = 0; i < 300; ++i) {
+        pool.resize(i % 2 ? 2 : 4);
+        runRounds(pool, 2, 16);
+    }
+}
+
+} // namespace
+
+int main() {
+    testSequential();
+    testParallel();
+    testResizeAfterRuns();
+    return TEST_RESULT();
+}
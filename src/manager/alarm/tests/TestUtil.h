@@ -0,0 +1,53 @@
+// TestUtil.h
+#pragma once
+#include <iostream>
+#include <cmath>
+#include <string>
+
+// 极简的单元测试断言：失败时输出位置并计数，不中断后续检查。
+// 每个测试文件是一个独立的可执行程序，main 返回 TEST_RESULT()，失败数不为0时退出码非0。
+namespace test {
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+inline void fail(const char* file, int line, const std::string& message) {
+    ++failures();
+    std::cerr << file << ":" << line << ": " << message << std::endl;
+}
+
+// 两个double相等，NaN与NaN视为相等
+inline bool sameValue(double a, double b) {
+    return (std::isnan(a) && std::isnan(b)) || a == b;
+}
+}
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) test::fail(__FILE__, __LINE__, "CHECK(" #cond ")");   \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance)                                                  \
+    do {                                                                                         \
+        double a_ = (actual), e_ = (expected);                                                   \
+        if (!(std::fabs(a_ - e_) <= (tolerance)))                                                \
+            test::fail(__FILE__, __LINE__, "CHECK_NEAR(" #actual ", " #expected "): got " +      \
+                                           std::to_string(a_) + ", expected " + std::to_string(e_)); \
+    } while (0)
+
+#define CHECK_THROWS(expr, exception_type)                                            \
+    do {                                                                              \
+        bool thrown_ = false;                                                         \
+        try {                                                                         \
+            (void)(expr);                                                             \
+        } catch (const exception_type&) {                                             \
+            thrown_ = true;                                                           \
+        }                                                                             \
+        if (!thrown_) test::fail(__FILE__, __LINE__, "CHECK_THROWS(" #expr ")");      \
+    } while (0)
+
+#define TEST_RESULT()                                                                   \
+    (test::failures() == 0 ? (std::cout << "PASS " << __FILE__ << std::endl, 0)         \
+                           : (std::cout << "FAIL " << __FILE__ << ": " << test::failures() \
+                                        << " check(s) failed" << std::endl, 1))
@@ -10,6 +10,7 @@
 #include <optional>
 #include <mutex>
 #include <atomic>
+#include <functional>
 
 // 前向声明
 namespace SQLite {
@@ -32,6 +33,9 @@ public:
     bool initializeNodeTables();
 
     // Node Status Monitor
+    // 节点状态变化（上线/离线）的回调，可能在上报处理线程或状态监控线程上调用；须在 initialize 之前设置
+    using NodeStatusListener = std::function<void(const std::string& host_ip, const std::string& status)>;
+    void setNodeStatusListener(NodeStatusListener listener);
     void startNodeStatusMonitorThread();
     bool updateNodeStatusOnly(const std::string& host_ip, const std::string& new_status);
 
@@ -67,6 +71,7 @@ private:
     // Node Status Monitor
     std::unique_ptr<std::thread> node_status_monitor_thread_;
     std::atomic<bool> node_status_monitor_running_{false}; // Initialize to false
+    NodeStatusListener node_status_listener_;
     void nodeStatusMonitorLoop(); // Method to be run by node_status_monitor_thread_
 };
 
@@ -218,6 +218,10 @@ bool DatabaseManager::updateNodeStatusOnly(const std::string& host_ip, const std
     }
 }
 
+void DatabaseManager::setNodeStatusListener(NodeStatusListener listener) {
+    node_status_listener_ = std::move(listener);
+}
+
 void DatabaseManager::startNodeStatusMonitorThread() {
     if (node_status_monitor_running_.load()) {
         return; 
@@ -250,7 +254,9 @@ void DatabaseManager::nodeStatusMonitorLoop() {
                     if ((now_epoch - last_updated_at) > 5) { 
                         std::cout << "Node with host_ip " << host_ip 
                                   << " is inactive. Setting status to offline via DatabaseManager." << std::endl;
-                        this->updateNodeStatusOnly(host_ip, "offline"); 
+                        if (this->updateNodeStatusOnly(host_ip, "offline") && node_status_listener_) {
+                            node_status_listener_(host_ip, "offline");
+                        }
                     }
                 }
             }
@@ -304,12 +310,14 @@ bool DatabaseManager::updateNode(const nlohmann::json& node_info) {
     }
 
     try {
-        SQLite::Statement query(*db_, "SELECT id FROM node WHERE box_id = ? AND slot_id = ? AND cpu_id = ?");
+        SQLite::Statement query(*db_, "SELECT id, status FROM node WHERE box_id = ? AND slot_id = ? AND cpu_id = ?");
         query.bind(1, box_id);
         query.bind(2, slot_id);
         query.bind(3, cpu_id);
 
+        bool came_online = true; // 新节点或由离线恢复
         if (query.executeStep()) { // Node exists, update it
+            came_online = query.getColumn(1).getString() != "online";
             SQLite::Statement update(*db_, R"(
                 UPDATE node 
                 SET srio_id = ?, host_ip = ?, hostname = ?, service_port = ?, 
@@ -360,6 +368,9 @@ bool DatabaseManager::updateNode(const nlohmann::json& node_info) {
             insert.bind(17, timestamp);
             insert.exec();
         }
+        if (came_online && node_status_listener_) {
+            node_status_listener_(host_ip, "online");
+        }
         return true;
     } catch (const std::exception& e) {
         std::cerr << "Error saving node: " << e.what() << std::endl;
@@ -4,8 +4,10 @@
 #include <utility>
 
 HTTPServer::HTTPServer(std::shared_ptr<DatabaseManager> db_manager,
+                       std::shared_ptr<ReportIngestor> report_ingestor,
                        int port)
     : db_manager_(std::move(db_manager)),
+      report_ingestor_(std::move(report_ingestor)),
       port_(port),
       running_(false)
 {
@@ -23,6 +25,21 @@ HTTPServer::~HTTPServer()
     }
 }
 
+void HTTPServer::setMetricCache(std::shared_ptr<MetricCache> metric_cache)
+{
+    metric_cache_ = std::move(metric_cache);
+}
+
+void HTTPServer::setActionDispatcher(std::shared_ptr<ActionDispatcher> action_dispatcher)
+{
+    action_dispatcher_ = std::move(action_dispatcher);
+}
+
+void HTTPServer::setAlarmEventRepository(std::shared_ptr<AlarmEventRepository> alarm_repository)
+{
+    alarm_repository_ = std::move(alarm_repository);
+}
+
 bool HTTPServer::start()
 {
     try {
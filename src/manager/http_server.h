@@ -10,6 +10,10 @@
 
 // 前向声明
 class DatabaseManager;
+class MetricCache;
+class ActionDispatcher;
+class AlarmEventRepository;
+class ReportIngestor;
 
 /**
  * HTTPServer类 - HTTP服务器
@@ -19,7 +23,9 @@ class DatabaseManager;
 class HTTPServer {
 public:
     // 构造与析构
-    HTTPServer(std::shared_ptr<DatabaseManager> db_manager, 
+    // report_ingestor 为心跳与资源上报的处理流程，可与其他接入通道共用
+    HTTPServer(std::shared_ptr<DatabaseManager> db_manager,
+              std::shared_ptr<ReportIngestor> report_ingestor,
               int port = 8080);
     ~HTTPServer();
 
@@ -27,6 +33,13 @@ public:
     bool start();
     void stop();
 
+    // 告警指标缓存（可选），用于查询缓存统计
+    void setMetricCache(std::shared_ptr<MetricCache> metric_cache);
+    // 告警动作分发器（可选），用于查询排队与丢弃统计
+    void setActionDispatcher(std::shared_ptr<ActionDispatcher> action_dispatcher);
+    // 告警事件存储（可选），提供事件查询接口
+    void setAlarmEventRepository(std::shared_ptr<AlarmEventRepository> alarm_repository);
+
     // 路由初始化
     void initNodeRoutes();
 
@@ -34,6 +47,9 @@ public:
     void handleGetAllNodes(const httplib::Request& req, httplib::Response& res);
     void handleHeartbeat(const httplib::Request& req, httplib::Response& res);
     void handleGetNodeMetrics(const httplib::Request& req, httplib::Response& res);
+    void handleGetAlarmCacheStats(const httplib::Request& req, httplib::Response& res);
+    void handleGetAlarmDispatcherStats(const httplib::Request& req, httplib::Response& res);
+    void handleGetAlarmEvents(const httplib::Request& req, httplib::Response& res);
 
     // 统一API响应方法
     void sendSuccessResponse(httplib::Response& res, const std::string& message);
@@ -44,6 +60,10 @@ public:
 protected:
     httplib::Server server_;  // HTTP服务器
     std::shared_ptr<DatabaseManager> db_manager_;    // 数据库管理器
+    std::shared_ptr<MetricCache> metric_cache_;      // 告警指标缓存
+    std::shared_ptr<ActionDispatcher> action_dispatcher_; // 告警动作分发器
+    std::shared_ptr<AlarmEventRepository> alarm_repository_; // 告警事件存储
+    std::shared_ptr<ReportIngestor> report_ingestor_; // 心跳与资源上报处理
 
 private:
     int port_;  // 监听端口
@@ -1,14 +1,29 @@
 #include "http_server.h"
 #include "database_manager.h"
+#include "report_ingestor.h"
+#include "alarm/MetricCache.h"
+#include "alarm/ActionDispatcher.h"
+#include "alarm/AlarmEventRepository.h"
 #include <iostream>
-#include <chrono>
+#include <string>
+#include <cerrno>
+#include <cstdlib>
+#include <algorithm>
 #include <nlohmann/json.hpp>
 
-// 工具函数：检查json字段
-static bool check_json_fields(const nlohmann::json& j, const std::vector<std::string>& fields) {
-    for (const auto& f : fields) {
-        if (!j.contains(f)) return false;
+// 工具函数：把查询参数严格解析为十进制整数，含非数字字符或超出范围时返回false
+static bool parse_int64_param(const std::string& text, int64_t& value)
+{
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    long long parsed = std::strtoll(text.c_str(), &end, 10);
+    if (errno == ERANGE || end != text.c_str() + text.size()) {
+        return false;
     }
+    value = parsed;
     return true;
 }
 
@@ -30,6 +45,19 @@ void HTTPServer::initNodeRoutes()
     // GET /node/metrics - 获取节点指标
     server_.Get("/node/metrics", [this](const httplib::Request &req, httplib::Response &res)
                 { handleGetNodeMetrics(req, res); });
+
+    // GET /alarms/cache/stats - 告警指标缓存的分片与锁竞争统计
+    server_.Get("/alarms/cache/stats", [this](const httplib::Request &req, httplib::Response &res)
+                { handleGetAlarmCacheStats(req, res); });
+
+    // GET /alarms/dispatcher/stats - 告警动作分发队列的排队、批次与丢弃统计
+    server_.Get("/alarms/dispatcher/stats", [this](const httplib::Request &req, httplib::Response &res)
+                { handleGetAlarmDispatcherStats(req, res); });
+
+    // GET /alarms/events - 按规则/模板/节点/事件类型/时间范围查询告警事件（键集分页），
+    // 带 group_by=rule|template|node 时返回分组计数
+    server_.Get("/alarms/events", [this](const httplib::Request &req, httplib::Response &res)
+                { handleGetAlarmEvents(req, res); });
 }
 
 // 处理节点心跳请求
@@ -44,33 +72,15 @@ void HTTPServer::handleHeartbeat(const httplib::Request &req, httplib::Response
             sendErrorResponse(res, "Invalid JSON: " + std::string(e.what()));
             return;
         }
-        
-        if (!check_json_fields(request_json, {"api_version", "data"})) {
-            sendErrorResponse(res, "Missing api_version or data field in request");
-            return;
-        }
-        
-        auto& data = request_json["data"];
-        
-        // 检查必要字段
-        if (!check_json_fields(data, {"box_id", "slot_id", "cpu_id"})) {
-            sendErrorResponse(res, "box_id, slot_id and cpu_id are required in data");
-            return;
-        }
-        
-        if (!db_manager_) {
-            sendErrorResponse(res, "Database manager not initialized");
-            return;
-        }
-        
-        // 调用updateNode保存节点信息
-        if (db_manager_->updateNode(data))
+
+        std::string error;
+        if (report_ingestor_->ingestHeartbeat(request_json, error))
         {
             sendSuccessResponse(res, "Node information updated successfully");
         }
         else
         {
-            sendErrorResponse(res, "Failed to update node information");
+            sendErrorResponse(res, error);
         }
     }
     catch (const std::exception &e)
@@ -91,40 +101,15 @@ void HTTPServer::handleResourceUpdate(const httplib::Request &req, httplib::Resp
             sendErrorResponse(res, "Invalid JSON: " + std::string(e.what()));
             return;
         }
-        
-        if (!check_json_fields(request_json, {"api_version", "data"})) {
-            sendErrorResponse(res, "Missing api_version or data field in request");
-            return;
-        }
-        
-        auto& data = request_json["data"];
-        
-        // 检查必要字段
-        if (!check_json_fields(data, {"host_ip", "resource"})) {
-            sendErrorResponse(res, "host_ip and resource are required in request body");
-            return;
-        }
-        
-        if (!db_manager_) {
-            sendErrorResponse(res, "Database manager not initialized");
-            return;
-        }
-        
-        // 构建metrics_data对象
-        nlohmann::json metrics_data = {
-            {"host_ip", data["host_ip"]},
-            {"timestamp", std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::system_clock::now().time_since_epoch()).count()},
-            {"resource", data["resource"]}
-        };
-        
-        if (db_manager_->saveNodeResourceUsage(metrics_data))
+
+        std::string error;
+        if (report_ingestor_->ingestResource(request_json, error))
         {
             sendSuccessResponse(res, "Resource data updated successfully");
         }
         else
         {
-            sendErrorResponse(res, "Failed to update resource data");
+            sendErrorResponse(res, error);
         }
     }
     catch (const std::exception &e)
@@ -134,7 +119,7 @@ void HTTPServer::handleResourceUpdate(const httplib::Request &req, httplib::Resp
 }
 
 // 处理获取所有节点信息
-void HTTPServer::handleGetAllNodes(const httplib::Request &req, httplib::Response &res)
+void HTTPServer::handleGetAllNodes(const httplib::Request &, httplib::Response &res)
 {
     try
     {
@@ -152,7 +137,7 @@ void HTTPServer::handleGetAllNodes(const httplib::Request &req, httplib::Respons
 }
 
 // 处理获取所有节点及其最新metrics
-void HTTPServer::handleGetNodeMetrics(const httplib::Request &req, httplib::Response &res)
+void HTTPServer::handleGetNodeMetrics(const httplib::Request &, httplib::Response &res)
 {
     try
     {
@@ -168,3 +153,89 @@ void HTTPServer::handleGetNodeMetrics(const httplib::Request &req, httplib::Resp
         sendExceptionResponse(res, e);
     }
 }
+
+// 处理获取告警指标缓存统计
+void HTTPServer::handleGetAlarmCacheStats(const httplib::Request &, httplib::Response &res)
+{
+    try
+    {
+        if (!metric_cache_) {
+            sendErrorResponse(res, "Alarm metric cache not initialized");
+            return;
+        }
+        sendSuccessResponse(res, "cache_stats", metric_cache_->getStats());
+    }
+    catch (const std::exception &e)
+    {
+        sendExceptionResponse(res, e);
+    }
+}
+
+// 处理获取告警动作分发统计
+void HTTPServer::handleGetAlarmDispatcherStats(const httplib::Request &, httplib::Response &res)
+{
+    try
+    {
+        if (!action_dispatcher_) {
+            sendErrorResponse(res, "Alarm action dispatcher not initialized");
+            return;
+        }
+        sendSuccessResponse(res, "dispatcher_stats", action_dispatcher_->getStatsJson());
+    }
+    catch (const std::exception &e)
+    {
+        sendExceptionResponse(res, e);
+    }
+}
+
+// 处理告警事件查询
+// 参数: rule_id, template_id, node_id, event_type, from, to（纪元毫秒）, limit, cursor, group_by
+// 风暴聚合事件的 node_id 为空，node_id 过滤与按节点分组按其 members 匹配
+void HTTPServer::handleGetAlarmEvents(const httplib::Request &req, httplib::Response &res)
+{
+    try
+    {
+        if (!alarm_repository_) {
+            sendErrorResponse(res, "Alarm event repository not initialized");
+            return;
+        }
+
+        AlarmEventQuery query;
+        query.ruleId = req.get_param_value("rule_id");
+        query.templateId = req.get_param_value("template_id");
+        query.nodeId = req.get_param_value("node_id");
+        query.eventType = req.get_param_value("event_type");
+        query.cursor = req.get_param_value("cursor");
+        if (req.has_param("from") && !parse_int64_param(req.get_param_value("from"), query.fromMs)) {
+            sendErrorResponse(res, "Invalid from, expected epoch milliseconds");
+            return;
+        }
+        if (req.has_param("to") && !parse_int64_param(req.get_param_value("to"), query.toMs)) {
+            sendErrorResponse(res, "Invalid to, expected epoch milliseconds");
+            return;
+        }
+        if (req.has_param("limit")) {
+            int64_t limit = 0;
+            if (!parse_int64_param(req.get_param_value("limit"), limit) || limit <= 0) {
+                sendErrorResponse(res, "Invalid limit, expected a positive integer");
+                return;
+            }
+            query.limit = static_cast<int>(std::min<int64_t>(limit, kMaxAlarmEventQueryLimit));
+        }
+        if (!query.eventType.empty() && query.eventType != "TRIGGERED" && query.eventType != "RECOVERED") {
+            sendErrorResponse(res, "Invalid event_type, expected TRIGGERED or RECOVERED");
+            return;
+        }
+
+        if (req.has_param("group_by")) {
+            sendSuccessResponse(res, "alarm_event_counts",
+                                alarm_repository_->countEvents(query, req.get_param_value("group_by")));
+        } else {
+            sendSuccessResponse(res, "alarm_events", alarm_repository_->queryEvents(query));
+        }
+    }
+    catch (const std::exception &e)
+    {
+        sendExceptionResponse(res, e);
+    }
+}
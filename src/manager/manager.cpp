@@ -2,8 +2,25 @@
 #include "http_server.h"
 #include "database_manager.h"
 #include "multicast_announcer.h"
+#include "report_ingestor.h"
+#include "zmq_ingest_server.h"
+#include "metric_publisher.h"
+#include "ConfigManager.h"
+#include "rpc_server.hpp"
+#include "alarm/MetricCache.h"
+#include "alarm/AlarmManager.h"
+#include "alarm/RuleProvisioner.h"
+#include "alarm/AlarmEventRepository.h"
+#include "alarm/ActionDispatcher.h"
+#include "alarm/GreaterThanCondition.h"
+#include "alarm/WindowCondition.h"
+#include "alarm/ConsecutiveCondition.h"
+#include "alarm/DeviationCondition.h"
+#include "alarm/LogAction.h"
+#include "alarm/DatabaseAction.h"
 #include <iostream>
 #include <thread>
+#include <algorithm>
 #include <chrono>
 #include <atomic>
 #include <sys/sysinfo.h>
@@ -12,8 +29,8 @@
 #include <fstream>
 #include <sstream>
 
-Manager::Manager(int port, const std::string& db_path)
-    : port_(port), db_path_(db_path), running_(false) {}
+Manager::Manager(int port, const std::string& db_path, const std::string& alarm_db_path)
+    : port_(port), db_path_(db_path), alarm_db_path_(alarm_db_path), running_(false) {}
 
 Manager::~Manager() {
     if (running_) {
@@ -23,20 +40,229 @@ Manager::~Manager() {
 
 bool Manager::initialize() {
     std::cout << "[Manager] 初始化..." << std::endl;
+    nlohmann::json config = ConfigManager::load("config.json");
+
+    // 配置了 publish_endpoint（如 tcp://*:5561）时通过 PUB 套接字发布已接收的上报与节点状态变化，
+    // publish_hwm 为每个订阅方的发送队列高水位，publish_encoding 为 json 或 msgpack
+    std::string publish_endpoint = ConfigManager::getString(config, "publish_endpoint", "");
+    if (!publish_endpoint.empty()) {
+        RpcEncoding encoding = ConfigManager::getString(config, "publish_encoding", "json") == "msgpack"
+                                   ? RpcEncoding::MSGPACK : RpcEncoding::JSON;
+        metric_publisher_ = std::make_shared<MetricPublisher>(
+            publish_endpoint, encoding, 10000, ConfigManager::getInt(config, "publish_hwm", 1000));
+    }
 
     db_manager_ = std::make_shared<DatabaseManager>(db_path_);
+    if (metric_publisher_) {
+        std::weak_ptr<MetricPublisher> weak_publisher = metric_publisher_;
+        db_manager_->setNodeStatusListener([weak_publisher](const std::string& host_ip, const std::string& status) {
+            if (auto publisher = weak_publisher.lock()) {
+                publisher->publish(host_ip, "status", {
+                    {"host_ip", host_ip},
+                    {"status", status},
+                    {"timestamp", std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count()}
+                });
+            }
+        });
+    }
     if (!db_manager_ || !db_manager_->initialize()) {
         std::cerr << "[Manager] 数据库管理器初始化失败" << std::endl;
         return false;
     }
 
-    http_server_ = std::make_unique<HTTPServer>(db_manager_, port_);
+    if (!initializeAlarmEngine()) {
+        std::cerr << "[Manager] 告警引擎初始化失败" << std::endl;
+        return false;
+    }
+
+    // HTTP接口与ZeroMQ接入通道共用同一套上报处理流程
+    report_ingestor_ = std::make_shared<ReportIngestor>(db_manager_);
+    report_ingestor_->setMetricCache(metric_cache_);
+    report_ingestor_->setMetricPublisher(metric_publisher_);
+
+    http_server_ = std::make_unique<HTTPServer>(db_manager_, report_ingestor_, port_);
+    http_server_->setMetricCache(metric_cache_);
+    http_server_->setActionDispatcher(action_dispatcher_);
+    http_server_->setAlarmEventRepository(alarm_repository_);
     multicast_announcer_ = std::make_unique<MulticastAnnouncer>(port_);
 
+    // 配置了 rpc_endpoint（如 tcp://*:5562）时启用查询RPC服务，支持批请求与 MessagePack 编码；
+    // rpc_workers 为工作线程数，rpc_batch_concurrency 为单个批请求内的并行度
+    std::string rpc_endpoint = ConfigManager::getString(config, "rpc_endpoint", "");
+    if (!rpc_endpoint.empty() &&
+        !initializeRpcServer(rpc_endpoint,
+                             static_cast<size_t>(std::max(0, ConfigManager::getInt(config, "rpc_workers", 4))),
+                             static_cast<size_t>(std::max(1, ConfigManager::getInt(config, "rpc_batch_concurrency", 4))))) {
+        std::cerr << "[Manager] 查询RPC服务初始化失败，仅提供HTTP接口" << std::endl;
+    }
+
+    // 配置了 ingest_endpoint（如 tcp://*:5560）时启用ZeroMQ上报接入通道，
+    // ingest_hwm 为接收队列高水位
+    std::string ingest_endpoint = ConfigManager::getString(config, "ingest_endpoint", "");
+    if (!ingest_endpoint.empty()) {
+        zmq_ingest_server_ = std::make_unique<ZmqIngestServer>(
+            report_ingestor_, ingest_endpoint, ConfigManager::getInt(config, "ingest_hwm", 1000));
+    }
+
     std::cout << "[Manager] 初始化成功" << std::endl;
     return true;
 }
 
+bool Manager::initializeAlarmEngine() {
+    try {
+        alarm_repository_ = std::make_shared<AlarmEventRepository>(alarm_db_path_);
+    } catch (const std::exception& e) {
+        std::cerr << "[Manager] 告警事件数据库打开失败: " << e.what() << std::endl;
+        return false;
+    }
+
+    metric_cache_ = std::make_shared<MetricCache>();
+    alarm_manager_ = std::make_shared<AlarmManager>(metric_cache_);
+    // 告警动作（日志、写库）交由分发器异步批量执行，检查线程不等待
+    action_dispatcher_ = std::make_shared<ActionDispatcher>();
+    alarm_manager_->setActionDispatcher(action_dispatcher_);
+    // 同一模板2秒内有3个及以上节点同向迁移时合并为一条通知，避免告警风暴刷屏和写库
+    alarm_manager_->setStormAggregation(std::chrono::seconds(2), 3);
+    // 规则与模板按节点分片并行评估，评估线程数取CPU核数
+    alarm_manager_->setSweepWorkers(std::max(1u, std::thread::hardware_concurrency()));
+    rule_provisioner_ = std::make_shared<RuleProvisioner>(alarm_manager_, metric_cache_);
+
+    // 上报数据写入缓存后，只评估该节点的规则及其所在分片上的模板
+    std::weak_ptr<AlarmManager> weak_alarm_manager = alarm_manager_;
+    metric_cache_->setUpdateListener([weak_alarm_manager](const std::string& node_id) {
+        if (auto alarm_manager = weak_alarm_manager.lock()) {
+            alarm_manager->markNodeDirty(node_id);
+        }
+    });
+
+    // 节点加入或过期时增量纳管，无需等待周期性的全量同步
+    std::weak_ptr<RuleProvisioner> weak_provisioner = rule_provisioner_;
+    metric_cache_->setMembershipListener([weak_provisioner](MetricCache::NodeIndex node,
+                                                            const std::string& node_id,
+                                                            MetricCache::NodeEvent event) {
+        if (auto provisioner = weak_provisioner.lock()) {
+            provisioner->onNodeEvent(node, node_id, event);
+        }
+    });
+
+    // 默认告警模板，指标名见 alarm/ResourceMetrics.h
+    auto log_action = std::make_shared<LogAction>();
+    auto triggered_action = std::make_shared<DatabaseAction>(alarm_repository_, AlarmEventType::TRIGGERED);
+    auto recovered_action = std::make_shared<DatabaseAction>(alarm_repository_, AlarmEventType::RECOVERED);
+
+    const std::vector<std::pair<std::string, std::string>> threshold_templates = {
+        {"tpl-high-cpu", "cpu_usage_percent"},
+        {"tpl-high-memory", "memory_usage_percent"},
+        {"tpl-high-disk", "disk_max_usage_percent"}
+    };
+    for (const auto& entry : threshold_templates) {
+        AlarmRuleTemplate tpl;
+        tpl.templateId = entry.first;
+        tpl.metricName = entry.second;
+        tpl.condition = std::make_shared<GreaterThanCondition>(90.0);
+        if (entry.first == "tpl-high-cpu") {
+            // CPU使用率波动大，按60秒均值判断，避免单次尖峰引起告警抖动
+            tpl.condition = WindowCondition::overDuration(WindowCondition::Aggregate::AVG,
+                                                          std::chrono::seconds(60), tpl.condition);
+        }
+        tpl.actions.push_back(log_action);
+        tpl.actions.push_back(triggered_action);
+        tpl.recoveryActions.push_back(recovered_action);
+        rule_provisioner_->addTemplate(tpl);
+    }
+
+    // CPU使用率相对本节点基线的异常：连续3次偏离超过4个标准差
+    // 标准差下限取1个百分点，避免长期空闲节点的微小波动被判为异常
+    MetricCache::BaselineConfig cpu_baseline;
+    cpu_baseline.minStdDev = 1.0;
+    metric_cache_->enableBaseline("cpu_usage_percent", cpu_baseline);
+    AlarmRuleTemplate anomaly_tpl;
+    anomaly_tpl.templateId = "tpl-cpu-anomaly";
+    anomaly_tpl.metricName = MetricCache::zscoreMetricName("cpu_usage_percent");
+    anomaly_tpl.condition = std::make_shared<ConsecutiveCondition>(std::make_shared<DeviationCondition>(4.0), 3);
+    anomaly_tpl.actions.push_back(log_action);
+    anomaly_tpl.actions.push_back(triggered_action);
+    anomaly_tpl.recoveryActions.push_back(recovered_action);
+    rule_provisioner_->addTemplate(anomaly_tpl);
+    return true;
+}
+
+bool Manager::initializeRpcServer(const std::string& endpoint, size_t worker_count, size_t batch_concurrency) {
+    try {
+        rpc_server_ = std::make_unique<RPCServer>(endpoint, worker_count);
+    } catch (const std::exception& e) {
+        std::cerr << "[Manager] 查询RPC服务绑定 " << endpoint << " 失败: " << e.what() << std::endl;
+        return false;
+    }
+    rpc_server_->setBatchConcurrency(batch_concurrency);
+
+    // 节点查询，与HTTP接口读取同一个数据库
+    std::shared_ptr<DatabaseManager> db = db_manager_;
+    rpc_server_->registerMethod("getAllNodes", [db]() { return db->getAllNodes(); });
+    rpc_server_->registerMethod("getNodeByhost_ip", [db](const std::string& host_ip) {
+        return db->getNodeByhost_ip(host_ip);
+    });
+    rpc_server_->registerMethod("getNodesWithLatestMetrics", [db]() { return db->getNodesWithLatestMetrics(); });
+
+    // 历史指标查询：参数为 (host_ip, limit)
+    rpc_server_->registerMethod("getNodeCpuMetrics", [db](const std::string& host_ip, int limit) {
+        return db->getNodeCpuMetrics(host_ip, limit);
+    });
+    rpc_server_->registerMethod("getNodeMemoryMetrics", [db](const std::string& host_ip, int limit) {
+        return db->getNodeMemoryMetrics(host_ip, limit);
+    });
+    rpc_server_->registerMethod("getNodeDiskMetrics", [db](const std::string& host_ip, int limit) {
+        return db->getNodeDiskMetrics(host_ip, limit);
+    });
+    rpc_server_->registerMethod("getNodeNetworkMetrics", [db](const std::string& host_ip, int limit) {
+        return db->getNodeNetworkMetrics(host_ip, limit);
+    });
+    rpc_server_->registerMethod("getNodeDockerMetrics", [db](const std::string& host_ip, int limit) {
+        return db->getNodeDockerMetrics(host_ip, limit);
+    });
+    rpc_server_->registerMethod("getNodeGpuMetrics", [db](const std::string& host_ip, int limit) {
+        return db->getNodeGpuMetrics(host_ip, limit);
+    });
+
+    // 管理节点自身的运行信息
+    rpc_server_->registerMethod("getSystemInfo", [this]() { return handleGetSystemInfo(); });
+    rpc_server_->registerMethod("getResourceUsage", [this]() { return handleGetResourceUsage(); });
+    rpc_server_->registerMethod("getProcessList", [this]() { return handleGetProcessList(); });
+    rpc_server_->registerMethod("getProcessInfo", [this](int pid) { return handleGetProcessInfo(pid); });
+    // 进程数很多时逐段返回：边读 /proc 边发送，不必先生成完整列表
+    rpc_server_->registerStreamMethod("streamProcessList", [this]() -> RPCServer::StreamProducer {
+        std::shared_ptr<DIR> dir(opendir("/proc"), [](DIR* d) {
+            if (d) {
+                closedir(d);
+            }
+        });
+        if (!dir) {
+            throw std::runtime_error("Failed to open /proc directory");
+        }
+        return [this, dir](json& item) {
+            struct dirent* entry;
+            while ((entry = readdir(dir.get())) != nullptr) {
+                std::string name = entry->d_name;
+                if (entry->d_type != DT_DIR || !std::all_of(name.begin(), name.end(), ::isdigit)) {
+                    continue;
+                }
+                try {
+                    item = handleGetProcessInfo(std::stoi(name));
+                    return true;
+                } catch (...) {
+                    // 忽略无法读取的进程信息
+                    continue;
+                }
+            }
+            return false;
+        };
+    });
+
+    std::cout << "[Manager] 查询RPC服务端点: " << endpoint << "，工作线程: " << worker_count << std::endl;
+    return true;
+}
+
 bool Manager::start() {
     if (running_) {
         std::cerr << "[Manager] 已经在运行" << std::endl;
@@ -45,6 +271,11 @@ bool Manager::start() {
 
     std::cout << "[Manager] 启动..." << std::endl;
 
+    // 先于上报接入启动，避免漏发启动后的首批上报
+    if (metric_publisher_ && !metric_publisher_->start()) {
+        std::cerr << "[Manager] 实时指标发布启动失败" << std::endl;
+    }
+
     if (http_server_) {
         std::thread server_thread([this]() {
             if (!http_server_->start()) {
@@ -56,10 +287,32 @@ bool Manager::start() {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
 
+    if (zmq_ingest_server_) {
+        if (zmq_ingest_server_->start()) {
+            multicast_announcer_->setIngestEndpoint(zmq_ingest_server_->getEndpoint());
+        } else {
+            std::cerr << "[Manager] ZeroMQ上报接入通道启动失败，仅使用HTTP接收上报" << std::endl;
+        }
+    }
+
     if (multicast_announcer_) {
         multicast_announcer_->start();
     }
 
+    if (rpc_server_) {
+        rpc_thread_ = std::thread([this]() { rpc_server_->start(); });
+    }
+
+    if (action_dispatcher_) {
+        action_dispatcher_->start();
+    }
+    if (alarm_manager_) {
+        alarm_manager_->start();
+    }
+    if (rule_provisioner_) {
+        rule_provisioner_->start();
+    }
+
     running_ = true;
     std::cout << "[Manager] 启动成功" << std::endl;
     return true;
@@ -76,9 +329,30 @@ void Manager::stop() {
     if (http_server_) {
         http_server_->stop();
     }
+    if (rpc_server_) {
+        rpc_server_->stop(); // 等待已接收的查询应答完毕
+    }
+    if (rpc_thread_.joinable()) {
+        rpc_thread_.join();
+    }
+    if (zmq_ingest_server_) {
+        zmq_ingest_server_->stop();
+    }
+    if (metric_publisher_) {
+        metric_publisher_->stop();
+    }
     if (multicast_announcer_) {
         multicast_announcer_->stop();
     }
+    if (rule_provisioner_) {
+        rule_provisioner_->stop();
+    }
+    if (alarm_manager_) {
+        alarm_manager_->stop();
+    }
+    if (action_dispatcher_) {
+        action_dispatcher_->stop(); // 写完已排队的告警事件
+    }
 
     running_ = false;
     std::cout << "[Manager] 已停止" << std::endl;
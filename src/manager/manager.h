@@ -4,12 +4,22 @@
 #include <string>
 #include <memory>
 #include <atomic>
+#include <thread>
 #include <nlohmann/json.hpp>
 
 // 前向声明
 class HTTPServer;
 class DatabaseManager;
 class MulticastAnnouncer;
+class ReportIngestor;
+class ZmqIngestServer;
+class MetricPublisher;
+class RPCServer;
+class MetricCache;
+class AlarmManager;
+class RuleProvisioner;
+class AlarmEventRepository;
+class ActionDispatcher;
 
 using json = nlohmann::json;
 
@@ -19,7 +29,8 @@ using json = nlohmann::json;
 class Manager
 {
 public:
-    Manager(int port = 8080, const std::string &db_path = "resource_monitor.db");
+    Manager(int port = 8080, const std::string &db_path = "resource_monitor.db",
+            const std::string &alarm_db_path = "alarm_events.db");
     ~Manager();
 
     // 初始化
@@ -30,6 +41,11 @@ public:
     void stop();
 
 private:
+    // 初始化告警引擎并加载默认告警模板
+    bool initializeAlarmEngine();
+    // 创建查询RPC服务并注册方法
+    bool initializeRpcServer(const std::string& endpoint, size_t worker_count, size_t batch_concurrency);
+
     // 处理RPC请求的方法
     json handleGetSystemInfo();
     json handleGetResourceUsage();
@@ -38,11 +54,24 @@ private:
 
     int port_;             // HTTP服务器端口
     std::string db_path_;  // 数据库文件路径
+    std::string alarm_db_path_; // 告警事件数据库文件路径
     std::atomic<bool> running_; // 运行标志
 
     std::unique_ptr<HTTPServer> http_server_;                    // HTTP服务器
     std::shared_ptr<DatabaseManager> db_manager_;                // 数据库管理器
     std::unique_ptr<MulticastAnnouncer> multicast_announcer_;    // 组播公告器
+    std::shared_ptr<ReportIngestor> report_ingestor_;            // 心跳与资源上报处理（HTTP与ZeroMQ共用）
+    std::unique_ptr<ZmqIngestServer> zmq_ingest_server_;         // ZeroMQ上报接入通道（可选）
+    std::shared_ptr<MetricPublisher> metric_publisher_;          // 实时指标发布（可选）
+    std::unique_ptr<RPCServer> rpc_server_;                      // 查询RPC服务（可选）
+    std::thread rpc_thread_;                                     // RPC服务线程
+
+    // 告警引擎
+    std::shared_ptr<MetricCache> metric_cache_;                  // 最新指标缓存
+    std::shared_ptr<AlarmManager> alarm_manager_;                // 告警规则评估
+    std::shared_ptr<RuleProvisioner> rule_provisioner_;          // 告警规则供应
+    std::shared_ptr<AlarmEventRepository> alarm_repository_;     // 告警事件存储
+    std::shared_ptr<ActionDispatcher> action_dispatcher_;        // 告警动作异步分发
 };
 
 #endif // MANAGER_MANAGER_H_
\ No newline at end of file
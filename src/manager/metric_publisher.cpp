@@ -0,0 +1,123 @@
+#include "metric_publisher.h"
+#include <iostream>
+#include <utility>
+
+MetricPublisher::MetricPublisher(const std::string& endpoint, RpcEncoding encoding,
+                                 size_t queue_capacity, int high_water_mark)
+    : endpoint_(endpoint),
+      encoding_(encoding),
+      queue_capacity_(queue_capacity),
+      high_water_mark_(high_water_mark),
+      context_(1),
+      running_(false)
+{
+}
+
+MetricPublisher::~MetricPublisher()
+{
+    stop();
+}
+
+bool MetricPublisher::start()
+{
+    if (running_) {
+        return true;
+    }
+    try {
+        socket_ = std::make_unique<zmq::socket_t>(context_, ZMQ_PUB);
+        socket_->set(zmq::sockopt::sndhwm, high_water_mark_);
+        socket_->set(zmq::sockopt::linger, 0);
+        socket_->bind(endpoint_);
+    } catch (const zmq::error_t& e) {
+        std::cerr << "[MetricPublisher] 绑定 " << endpoint_ << " 失败: " << e.what() << std::endl;
+        socket_.reset();
+        return false;
+    }
+
+    std::cout << "[MetricPublisher] 启动，端点: " << endpoint_ << std::endl;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_requested_ = false;
+    }
+    running_ = true;
+    thread_ = std::thread(&MetricPublisher::run, this);
+    return true;
+}
+
+void MetricPublisher::stop()
+{
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_requested_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    std::cout << "[MetricPublisher] 已停止，发布 " << published_ << " 条，丢弃 " << dropped_ << " 条" << std::endl;
+}
+
+void MetricPublisher::publish(const std::string& host_ip, const std::string& category, nlohmann::json payload)
+{
+    if (!running_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.size() >= queue_capacity_) {
+            ++dropped_;
+            return;
+        }
+        queue_.push_back(Item{host_ip + "/" + category, std::move(payload)});
+    }
+    cv_.notify_one();
+}
+
+nlohmann::json MetricPublisher::getStats()
+{
+    size_t depth;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        depth = queue_.size();
+    }
+    return {
+        {"endpoint", endpoint_},
+        {"published", published_.load()},
+        {"dropped", dropped_.load()},
+        {"queue_depth", depth}
+    };
+}
+
+void MetricPublisher::run()
+{
+    std::deque<Item> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stop_requested_ || !queue_.empty(); });
+            if (stop_requested_) {
+                break; // 停止时不再发送排队的消息，订阅方本就可能丢失消息
+            }
+            batch.swap(queue_);
+        }
+
+        for (auto& item : batch) {
+            try {
+                // 编码在发布线程上进行，上报处理线程只负责入队
+                zmq::message_t body = rpc_codec::encode(item.payload, encoding_);
+                socket_->send(zmq::buffer(item.topic), zmq::send_flags::sndmore);
+                socket_->send(body, zmq::send_flags::dontwait);
+                ++published_;
+            } catch (const std::exception& e) {
+                ++dropped_;
+                std::cerr << "[MetricPublisher] 发布 " << item.topic << " 失败: " << e.what() << std::endl;
+            }
+        }
+        batch.clear();
+    }
+    socket_.reset();
+}
@@ -0,0 +1,69 @@
+#ifndef METRIC_PUBLISHER_H
+#define METRIC_PUBLISHER_H
+
+#include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#include <cstdint>
+#include <zmq.hpp>
+#include <nlohmann/json.hpp>
+#include "rpc_codec.hpp"
+
+/**
+ * MetricPublisher类 - 实时指标发布
+ *
+ * 通过 PUB 套接字向订阅方（历史库、第二套告警引擎、测试工具等）推送已接收的上报与节点状态变化，
+ * 订阅方无需轮询HTTP接口，也不增加数据库负载。
+ * 每条消息两帧：主题 "<host_ip>/<类别>" 与内容（JSON 文本或 MessagePack），
+ * 类别为资源上报中的指标族（cpu、memory、disk、network、docker、gpu）以及 heartbeat、status，
+ * 订阅方可按前缀在套接字层面过滤，如 "10.0.0.5/" 订阅该节点的全部消息。
+ * publish 只把消息放入有界队列即返回，由发布线程编码和发送；队列满时丢弃新消息并计数，
+ * 慢订阅方由 PUB 套接字按高水位丢弃，都不会拖慢上报处理线程
+ */
+class MetricPublisher {
+public:
+    MetricPublisher(const std::string& endpoint, RpcEncoding encoding = RpcEncoding::JSON,
+                    size_t queue_capacity = 10000, int high_water_mark = 1000);
+    ~MetricPublisher();
+
+    // 启动与停止
+    bool start();
+    void stop();
+
+    // 放入发布队列，可在任意线程调用；未启动时忽略
+    void publish(const std::string& host_ip, const std::string& category, nlohmann::json payload);
+
+    // 发布统计
+    nlohmann::json getStats();
+
+private:
+    struct Item {
+        std::string topic;
+        nlohmann::json payload;
+    };
+
+    void run();
+
+    std::string endpoint_;       // 绑定的端点
+    RpcEncoding encoding_;       // 消息内容的编码
+    size_t queue_capacity_;      // 发布队列容量（消息数）
+    int high_water_mark_;        // 每个订阅方的发送队列高水位
+    zmq::context_t context_;
+    std::unique_ptr<zmq::socket_t> socket_;  // PUB 套接字，启动后仅发布线程使用
+    std::thread thread_;
+    std::atomic<bool> running_;
+
+    std::deque<Item> queue_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_requested_ = false;
+
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+#endif // METRIC_PUBLISHER_H
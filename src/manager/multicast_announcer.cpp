@@ -39,6 +39,10 @@ void MulticastAnnouncer::stop() {
     if (thread_.joinable()) thread_.join();
 }
 
+void MulticastAnnouncer::setIngestEndpoint(const std::string& endpoint) {
+    ingest_endpoint_ = endpoint;
+}
+
 // 多播主循环，定期广播本机IP和端口
 void MulticastAnnouncer::run() {
     int sock = socket(AF_INET, SOCK_DGRAM, 0);
@@ -83,6 +87,10 @@ void MulticastAnnouncer::sendMulticast(int sock, const sockaddr_in& addr, const
         {"manager_port", port_},
         {"url", url}
     };
+    if (!ingest_endpoint_.empty()) {
+        // 节点据此改用ZeroMQ推送上报，无需额外配置
+        data_json["ingest_endpoint"] = getAdvertisedEndpoint(ingest_endpoint_, local_ip);
+    }
     nlohmann::json msg_json = {
         {"api_version", 1},
         {"data", data_json}
@@ -94,6 +102,17 @@ void MulticastAnnouncer::sendMulticast(int sock, const sockaddr_in& addr, const
     }
 }
 
+// 绑定在通配地址上的端点（如 tcp://*:5560）替换为本机IP，供节点连接
+std::string MulticastAnnouncer::getAdvertisedEndpoint(const std::string& endpoint, const std::string& local_ip) {
+    for (const std::string wildcard : {"://*:", "://0.0.0.0:"}) {
+        size_t pos = endpoint.find(wildcard);
+        if (pos != std::string::npos) {
+            return endpoint.substr(0, pos + 3) + local_ip + endpoint.substr(pos + wildcard.size() - 1);
+        }
+    }
+    return endpoint;
+}
+
 // 获取指定网卡的IP地址（如"en0"、"eth0"）
 std::string MulticastAnnouncer::getLocalIp(const std::string& ifname) {
     int fd = socket(AF_INET, SOCK_DGRAM, 0);
@@ -14,11 +14,14 @@ public:
     ~MulticastAnnouncer();
     void start();
     void stop();
+    // 随公告一并发布的ZeroMQ上报接入端点（为空则不发布），须在 start 之前设置
+    void setIngestEndpoint(const std::string& endpoint);
     void sendMulticast(int sock, const sockaddr_in& addr, const std::string& local_ip, const std::string& url);
 
 private:
     void run();
     std::string getLocalIp(const std::string& interface_name);
+    std::string getAdvertisedEndpoint(const std::string& endpoint, const std::string& local_ip);
     int port_;
     std::string multicast_addr_;
     int multicast_port_;
@@ -26,6 +29,7 @@ private:
     std::thread thread_;
     std::atomic<bool> running_;
     std::string local_ip_;
+    std::string ingest_endpoint_;
 };
 
 #endif // MULTICAST_ANNOUNCER_H 
\ No newline at end of file
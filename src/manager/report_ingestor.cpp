@@ -0,0 +1,147 @@
+#include "report_ingestor.h"
+#include "database_manager.h"
+#include "metric_publisher.h"
+#include "alarm/MetricCache.h"
+#include "alarm/ResourceMetrics.h"
+#include <chrono>
+#include <vector>
+#include <utility>
+
+// 工具函数：检查json字段
+static bool check_json_fields(const nlohmann::json& j, const std::vector<std::string>& fields) {
+    for (const auto& f : fields) {
+        if (!j.contains(f)) return false;
+    }
+    return true;
+}
+
+// 工具函数：检查心跳中 updateNode 读取的字段类型，必选字段须为整数，可选字段存在时类型须正确
+static bool check_heartbeat_types(const nlohmann::json& data, std::string& error) {
+    for (const char* f : {"box_id", "slot_id", "cpu_id"}) {
+        if (!data[f].is_number_integer()) {
+            error = std::string(f) + " must be an integer";
+            return false;
+        }
+    }
+    for (const char* f : {"srio_id", "service_port"}) {
+        if (data.contains(f) && !data[f].is_number_integer()) {
+            error = std::string(f) + " must be an integer";
+            return false;
+        }
+    }
+    for (const char* f : {"host_ip", "hostname", "box_type", "board_type", "cpu_type",
+                          "os_type", "resource_type", "cpu_arch"}) {
+        if (data.contains(f) && !data[f].is_string()) {
+            error = std::string(f) + " must be a string";
+            return false;
+        }
+    }
+    return true;
+}
+
+ReportIngestor::ReportIngestor(std::shared_ptr<DatabaseManager> db_manager)
+    : db_manager_(std::move(db_manager))
+{
+}
+
+void ReportIngestor::setMetricCache(std::shared_ptr<MetricCache> metric_cache)
+{
+    metric_cache_ = std::move(metric_cache);
+}
+
+void ReportIngestor::setMetricPublisher(std::shared_ptr<MetricPublisher> metric_publisher)
+{
+    metric_publisher_ = std::move(metric_publisher);
+}
+
+bool ReportIngestor::ingestHeartbeat(const nlohmann::json& request, std::string& error)
+{
+    if (!check_json_fields(request, {"api_version", "data"})) {
+        error = "Missing api_version or data field in request";
+        return false;
+    }
+
+    const auto& data = request["data"];
+
+    // 检查必要字段；类型须在写库之前检查，不能在节点信息已更新后才失败
+    if (!data.is_object() || !check_json_fields(data, {"box_id", "slot_id", "cpu_id"})) {
+        error = "box_id, slot_id and cpu_id are required in data";
+        return false;
+    }
+    if (!check_heartbeat_types(data, error)) {
+        return false;
+    }
+
+    if (!db_manager_) {
+        error = "Database manager not initialized";
+        return false;
+    }
+
+    // 调用updateNode保存节点信息
+    if (!db_manager_->updateNode(data)) {
+        error = "Failed to update node information";
+        return false;
+    }
+
+    if (metric_publisher_) {
+        metric_publisher_->publish(data.value("host_ip", ""), "heartbeat", data);
+    }
+    return true;
+}
+
+bool ReportIngestor::ingestResource(const nlohmann::json& request, std::string& error)
+{
+    if (!check_json_fields(request, {"api_version", "data"})) {
+        error = "Missing api_version or data field in request";
+        return false;
+    }
+
+    const auto& data = request["data"];
+
+    // 检查必要字段
+    if (!data.is_object() || !check_json_fields(data, {"host_ip", "resource"})) {
+        error = "host_ip and resource are required in request body";
+        return false;
+    }
+    if (!data["host_ip"].is_string() || !data["resource"].is_object()) {
+        error = "host_ip must be a string and resource must be an object";
+        return false;
+    }
+
+    if (!db_manager_) {
+        error = "Database manager not initialized";
+        return false;
+    }
+
+    // 先推送到告警缓存，告警评估不必等待数据库写入
+    if (metric_cache_) {
+        metric_cache_->updateNodeMetrics(data["host_ip"].get<std::string>(),
+                                         extractResourceMetrics(data["resource"]));
+    }
+
+    // 构建metrics_data对象
+    nlohmann::json metrics_data = {
+        {"host_ip", data["host_ip"]},
+        {"timestamp", std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count()},
+        {"resource", data["resource"]}
+    };
+
+    if (!db_manager_->saveNodeResourceUsage(metrics_data)) {
+        error = "Failed to update resource data";
+        return false;
+    }
+
+    // 每个指标族单独发布，订阅方可只订阅关心的类别
+    if (metric_publisher_) {
+        const std::string host_ip = data["host_ip"].get<std::string>();
+        for (auto it = data["resource"].begin(); it != data["resource"].end(); ++it) {
+            metric_publisher_->publish(host_ip, it.key(), {
+                {"host_ip", host_ip},
+                {"timestamp", metrics_data["timestamp"]},
+                {it.key(), it.value()}
+            });
+        }
+    }
+    return true;
+}
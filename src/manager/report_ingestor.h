@@ -0,0 +1,38 @@
+#ifndef REPORT_INGESTOR_H
+#define REPORT_INGESTOR_H
+
+#include <string>
+#include <memory>
+#include <nlohmann/json.hpp>
+
+// 前向声明
+class DatabaseManager;
+class MetricCache;
+class MetricPublisher;
+
+/**
+ * ReportIngestor类 - 节点上报处理
+ *
+ * 校验节点的心跳与资源上报并写入告警缓存和数据库，
+ * HTTP接口与ZeroMQ接入通道共用同一套处理流程
+ */
+class ReportIngestor {
+public:
+    explicit ReportIngestor(std::shared_ptr<DatabaseManager> db_manager);
+
+    // 告警指标缓存（可选），资源上报会同步写入
+    void setMetricCache(std::shared_ptr<MetricCache> metric_cache);
+    // 实时指标发布（可选），上报处理成功后按指标族发布
+    void setMetricPublisher(std::shared_ptr<MetricPublisher> metric_publisher);
+
+    // 处理上报消息（含 api_version 与 data 字段），失败时返回false并在 error 中说明原因
+    bool ingestHeartbeat(const nlohmann::json& request, std::string& error);
+    bool ingestResource(const nlohmann::json& request, std::string& error);
+
+private:
+    std::shared_ptr<DatabaseManager> db_manager_;    // 数据库管理器
+    std::shared_ptr<MetricCache> metric_cache_;      // 告警指标缓存
+    std::shared_ptr<MetricPublisher> metric_publisher_; // 实时指标发布
+};
+
+#endif // REPORT_INGESTOR_H
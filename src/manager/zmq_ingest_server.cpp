@@ -0,0 +1,118 @@
+#include "zmq_ingest_server.h"
+#include "report_ingestor.h"
+#include "rpc_codec.hpp"
+#include <iostream>
+#include <chrono>
+#include <utility>
+
+ZmqIngestServer::ZmqIngestServer(std::shared_ptr<ReportIngestor> report_ingestor,
+                                 const std::string& endpoint, int high_water_mark)
+    : report_ingestor_(std::move(report_ingestor)),
+      endpoint_(endpoint),
+      high_water_mark_(high_water_mark),
+      context_(1),
+      running_(false)
+{
+}
+
+ZmqIngestServer::~ZmqIngestServer()
+{
+    stop();
+}
+
+bool ZmqIngestServer::start()
+{
+    if (running_) {
+        return true;
+    }
+    try {
+        socket_ = std::make_unique<zmq::socket_t>(context_, ZMQ_PULL);
+        socket_->set(zmq::sockopt::rcvhwm, high_water_mark_);
+        socket_->set(zmq::sockopt::linger, 0);
+        socket_->bind(endpoint_);
+    } catch (const zmq::error_t& e) {
+        std::cerr << "[ZmqIngestServer] 绑定 " << endpoint_ << " 失败: " << e.what() << std::endl;
+        socket_.reset();
+        return false;
+    }
+
+    std::cout << "[ZmqIngestServer] 启动，端点: " << endpoint_ << std::endl;
+    running_ = true;
+    thread_ = std::thread(&ZmqIngestServer::run, this);
+    return true;
+}
+
+void ZmqIngestServer::stop()
+{
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+const std::string& ZmqIngestServer::getEndpoint() const
+{
+    return endpoint_;
+}
+
+void ZmqIngestServer::run()
+{
+    while (running_) {
+        try {
+            zmq::pollitem_t item = {static_cast<void*>(*socket_), 0, ZMQ_POLLIN, 0};
+            zmq::poll(&item, 1, std::chrono::milliseconds(100));
+            if (!(item.revents & ZMQ_POLLIN)) {
+                continue;
+            }
+
+            // 一次唤醒处理完所有已到达的消息
+            zmq::message_t type;
+            while (running_ && socket_->recv(type, zmq::recv_flags::dontwait)) {
+                if (!type.more()) {
+                    std::cerr << "[ZmqIngestServer] 丢弃缺少上报内容的消息" << std::endl;
+                    continue;
+                }
+                zmq::message_t body;
+                if (!socket_->recv(body, zmq::recv_flags::none)) {
+                    break;
+                }
+                // 丢弃多余的帧
+                bool extra = body.more();
+                while (extra) {
+                    zmq::message_t part;
+                    if (!socket_->recv(part, zmq::recv_flags::none)) {
+                        break;
+                    }
+                    extra = part.more();
+                }
+                handleMessage(type.to_string(), body);
+            }
+        } catch (const zmq::error_t& e) {
+            std::cerr << "[ZmqIngestServer] 接收异常: " << e.what() << std::endl;
+        }
+    }
+    socket_.reset();
+}
+
+void ZmqIngestServer::handleMessage(const std::string& type, const zmq::message_t& body)
+{
+    try {
+        // 直接从消息缓冲区解析
+        nlohmann::json request = rpc_codec::decode(body);
+
+        std::string error;
+        bool ok = false;
+        if (type == "/resource") {
+            ok = report_ingestor_->ingestResource(request, error);
+        } else if (type == "/heartbeat") {
+            ok = report_ingestor_->ingestHeartbeat(request, error);
+        } else {
+            error = "Unknown report type";
+        }
+        if (!ok) {
+            std::cerr << "[ZmqIngestServer] 处理 " << type << " 上报失败: " << error << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[ZmqIngestServer] 处理 " << type << " 上报异常: " << e.what() << std::endl;
+    }
+}
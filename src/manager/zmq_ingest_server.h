@@ -0,0 +1,49 @@
+#ifndef ZMQ_INGEST_SERVER_H
+#define ZMQ_INGEST_SERVER_H
+
+#include <string>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <zmq.hpp>
+
+// 前向声明
+class ReportIngestor;
+
+/**
+ * ZmqIngestServer类 - ZeroMQ上报接入通道
+ *
+ * 绑定 PULL 套接字接收节点单向推送的心跳与资源上报，不返回应答，
+ * 交给与HTTP接口相同的 ReportIngestor 处理。
+ * 每条消息两帧：上报类型（"/heartbeat" 或 "/resource"，与HTTP路径一致）
+ * 和与HTTP请求体相同的上报内容（JSON 文本或 MessagePack）。
+ * 上报在接收线程上顺序处理，处理跟不上时消息积压在接收队列，达到高水位后
+ * 节点的 PUSH 套接字随之阻塞（或非阻塞发送失败），形成自然的背压
+ */
+class ZmqIngestServer {
+public:
+    ZmqIngestServer(std::shared_ptr<ReportIngestor> report_ingestor,
+                    const std::string& endpoint, int high_water_mark = 1000);
+    ~ZmqIngestServer();
+
+    // 启动与停止
+    bool start();
+    void stop();
+
+    // 绑定的端点，如 tcp://*:5560
+    const std::string& getEndpoint() const;
+
+private:
+    void run();
+    void handleMessage(const std::string& type, const zmq::message_t& body);
+
+    std::shared_ptr<ReportIngestor> report_ingestor_;  // 上报处理流程
+    std::string endpoint_;       // 绑定的端点
+    int high_water_mark_;        // 接收队列高水位（消息数）
+    zmq::context_t context_;
+    std::unique_ptr<zmq::socket_t> socket_;  // PULL 套接字，启动后仅接收线程使用
+    std::thread thread_;
+    std::atomic<bool> running_;
+};
+
+#endif // ZMQ_INGEST_SERVER_H
@@ -23,6 +23,7 @@ int main(int argc, char* argv[]) {
     // 默认参数
     int port = 8080;
     std::string db_path = "resource_monitor.db";
+    std::string alarm_db_path = "alarm_events.db";
     
     // 解析命令行参数
     for (int i = 1; i < argc; i++) {
@@ -31,11 +32,14 @@ int main(int argc, char* argv[]) {
             port = std::atoi(argv[++i]);
         } else if (arg == "--db-path" && i + 1 < argc) {
             db_path = argv[++i];
+        } else if (arg == "--alarm-db-path" && i + 1 < argc) {
+            alarm_db_path = argv[++i];
         } else if (arg == "--help") {
             std::cout << "Usage: manager [options]" << std::endl;
             std::cout << "Options:" << std::endl;
             std::cout << "  --port <port>       HTTP server port (default: 8080)" << std::endl;
             std::cout << "  --db-path <path>    Database file path (default: resource_monitor.db)" << std::endl;
+            std::cout << "  --alarm-db-path <path>  Alarm event database path (default: alarm_events.db)" << std::endl;
             std::cout << "  --help              Show this help message" << std::endl;
             return 0;
         }
@@ -46,7 +50,7 @@ int main(int argc, char* argv[]) {
     signal(SIGTERM, signalHandler);
     
     // 创建Manager实例
-    g_manager = std::make_unique<Manager>(port, db_path);
+    g_manager = std::make_unique<Manager>(port, db_path, alarm_db_path);
     
     if (!g_manager->initialize()) {
         std::cerr << "Failed to initialize manager" << std::endl;
@@ -0,0 +1,428 @@
+#include "rpc_server.hpp"
+#include "rpc_client.hpp"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <functional>
+#include <unistd.h>
+
+// RPC 吞吐量与延迟基准测试。
+// 在进程内启动 RPCServer，用各种客户端模式并发调用，
+// 报告每个场景的 calls/s 与延迟分位数，用于定量比较 RPC 层的改动。
+// 服务端与客户端各有自己的 zmq 上下文，inproc:// 无法跨上下文连接，
+// 因此“进程内”场景实际经 ipc:// 传输，另有 tcp 回环作对照。
+// stream 模式以 callStream 拉取 streamProcessList 的全部元素：calls 列为收到的元素数（calls/s 即 items/s），
+// 延迟列为首段延迟（time-to-first-chunk）；该模式不测标量调用，payload 为0的场景跳过。
+//
+// 用法: bench_rpc [--key=value ...]
+//   --duration-ms=500        每个场景的运行时长
+//   --concurrency=1,8        并发度：同步模式为客户端线程数，异步模式为在途调用数
+//   --payload=0,100,2000     0 为标量调用 add，N>0 为返回 N 个进程的 getProcessList
+//   --workers=4              多线程服务端的工作线程数
+//   --batch=16               批调用模式每批的调用数
+//   --chunk=100              stream 模式每段的元素数
+//   --transport=ipc,tcp
+//   --server=single,workers
+//   --client=sync,batch,async,stream
+//   --encoding=json,msgpack
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchConfig {
+    int duration_ms = 500;
+    std::vector<int> concurrency = {1, 8};
+    std::vector<int> payloads = {0, 100, 2000};
+    int workers = 4;
+    int batch = 16;
+    int chunk = 100;
+    std::vector<std::string> transports = {"ipc", "tcp"};
+    std::vector<std::string> servers = {"single", "workers"};
+    std::vector<std::string> clients = {"sync", "batch", "async", "stream"};
+    std::vector<std::string> encodings = {"json", "msgpack"};
+};
+
+struct BenchResult {
+    size_t calls = 0;
+    size_t errors = 0;
+    double seconds = 0;
+    std::vector<double> latencies_us;   // 批模式为每批的往返延迟，流模式为首段延迟
+};
+
+std::vector<std::string> splitList(const std::string& value) {
+    std::vector<std::string> items;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+std::vector<int> splitIntList(const std::string& value) {
+    std::vector<int> items;
+    for (const auto& item : splitList(value)) {
+        items.push_back(std::stoi(item));
+    }
+    return items;
+}
+
+bool parseArgs(int argc, char* argv[], BenchConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos) {
+            std::cerr << "无法识别的参数: " << arg << std::endl;
+            return false;
+        }
+        std::string key = arg.substr(2, eq - 2);
+        std::string value = arg.substr(eq + 1);
+        if (key == "duration-ms") {
+            config.duration_ms = std::stoi(value);
+        } else if (key == "concurrency") {
+            config.concurrency = splitIntList(value);
+        } else if (key == "payload") {
+            config.payloads = splitIntList(value);
+        } else if (key == "workers") {
+            config.workers = std::max(1, std::stoi(value));
+        } else if (key == "batch") {
+            config.batch = std::max(1, std::stoi(value));
+        } else if (key == "chunk") {
+            config.chunk = std::max(1, std::stoi(value));
+        } else if (key == "transport") {
+            config.transports = splitList(value);
+        } else if (key == "server") {
+            config.servers = splitList(value);
+        } else if (key == "client") {
+            config.clients = splitList(value);
+        } else if (key == "encoding") {
+            config.encodings = splitList(value);
+        } else {
+            std::cerr << "无法识别的参数: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// 与 example.cpp 中 getProcessList 相同结构的进程列表
+json makeProcessList(int count) {
+    json processes = json::array();
+    for (int i = 0; i < count; ++i) {
+        processes.push_back({
+            {"pid", 1000 + i},
+            {"name", "process-" + std::to_string(i)},
+            {"status", "running"},
+            {"cpu_usage", (i % 100) * 0.37},
+            {"memory_usage", 4096 * (i + 1)},
+            {"command", "/usr/bin/process-" + std::to_string(i) + " --config /etc/process.conf"}
+        });
+    }
+    return processes;
+}
+
+// 被测的服务端：方法与 example.cpp 中的计算器一致，进程列表按负载大小预先生成
+class BenchServer {
+public:
+    BenchServer(const std::string& endpoint, size_t workers, const std::vector<int>& payloads, int chunk)
+        : server_(endpoint, workers) {
+        for (int payload : payloads) {
+            if (payload > 0) {
+                process_lists_[payload] = std::make_shared<const json>(makeProcessList(payload));
+            }
+        }
+        server_.setBatchConcurrency(workers > 0 ? workers : 1);
+        server_.setStreamChunkSize(static_cast<size_t>(chunk));
+        server_.setStreamLimits(1024, std::chrono::seconds(60));
+        server_.registerMethod("add", [](int a, int b) { return a + b; });
+        server_.registerMethod("getProcessList", [this](int count) {
+            return *processList(count);
+        });
+        // 与 manager 的 streamProcessList 相同，逐个产生进程列表中的元素
+        server_.registerStreamMethod("streamProcessList", [this](int count) {
+            auto processes = processList(count);
+            auto index = std::make_shared<size_t>(0);
+            return RPCServer::StreamProducer([processes, index](json& item) {
+                if (*index >= processes->size()) {
+                    return false;
+                }
+                item = (*processes)[(*index)++];
+                return true;
+            });
+        });
+        thread_ = std::thread([this]() { server_.start(); });
+    }
+
+    ~BenchServer() {
+        server_.stop();
+        thread_.join();
+    }
+
+private:
+    std::shared_ptr<const json> processList(int count) const {
+        auto it = process_lists_.find(count);
+        return it != process_lists_.end() ? it->second : std::make_shared<const json>(makeProcessList(count));
+    }
+
+    RPCServer server_;
+    std::map<int, std::shared_ptr<const json>> process_lists_;
+    std::thread thread_;
+};
+
+json callPayload(RPCClient& client, int payload) {
+    return payload > 0 ? client.call("getProcessList", payload) : client.call("add", 1, 2);
+}
+
+std::pair<std::string, json> payloadCall(int payload) {
+    return payload > 0 ? std::make_pair(std::string("getProcessList"), json::array({payload}))
+                       : std::make_pair(std::string("add"), json::array({1, 2}));
+}
+
+double elapsedUs(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+// 同步模式：每个线程一个 RPCClient（REQ），逐个调用；batch_size>1 时每次往返发送一批
+BenchResult runSync(const std::string& endpoint, RpcEncoding encoding, int threads,
+                    int payload, int batch_size, Clock::time_point start, Clock::time_point deadline) {
+    std::vector<BenchResult> partial(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            BenchResult& result = partial[t];
+            RPCClient client(endpoint, encoding);
+            std::vector<std::pair<std::string, json>> batch(batch_size, payloadCall(payload));
+            while (Clock::now() < deadline) {
+                auto call_start = Clock::now();
+                try {
+                    if (batch_size > 1) {
+                        json responses = client.callBatch(batch);
+                        for (const auto& response : responses) {
+                            if (response.is_null() || response.contains("error")) {
+                                ++result.errors;
+                            }
+                        }
+                        result.calls += batch.size();
+                    } else {
+                        callPayload(client, payload);
+                        ++result.calls;
+                    }
+                } catch (const std::exception& e) {
+                    // REQ 套接字出错后状态不可恢复，结束该线程
+                    ++result.errors;
+                    std::cerr << "调用失败: " << e.what() << std::endl;
+                    break;
+                }
+                result.latencies_us.push_back(elapsedUs(call_start));
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    BenchResult total;
+    total.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    for (auto& result : partial) {
+        total.calls += result.calls;
+        total.errors += result.errors;
+        total.latencies_us.insert(total.latencies_us.end(), result.latencies_us.begin(), result.latencies_us.end());
+    }
+    return total;
+}
+
+// 流模式：每个线程一个 RPCClient，反复以 callStream 拉取完整的进程列表；
+// calls 计收到的元素数，延迟记录 callStream 返回（收到第一段）所用的时间
+BenchResult runStream(const std::string& endpoint, RpcEncoding encoding, int threads,
+                      int payload, Clock::time_point start, Clock::time_point deadline) {
+    std::vector<BenchResult> partial(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            BenchResult& result = partial[t];
+            RPCClient client(endpoint, encoding);
+            while (Clock::now() < deadline) {
+                auto call_start = Clock::now();
+                try {
+                    RPCClient::Stream stream = client.callStream("streamProcessList", payload);
+                    result.latencies_us.push_back(elapsedUs(call_start));
+                    json item;
+                    size_t items = 0;
+                    while (stream.next(item)) {
+                        ++items;
+                    }
+                    if (items != static_cast<size_t>(payload)) {
+                        ++result.errors;
+                    }
+                    result.calls += items;
+                } catch (const std::exception& e) {
+                    ++result.errors;
+                    std::cerr << "调用失败: " << e.what() << std::endl;
+                    break;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    BenchResult total;
+    total.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    for (auto& result : partial) {
+        total.calls += result.calls;
+        total.errors += result.errors;
+        total.latencies_us.insert(total.latencies_us.end(), result.latencies_us.begin(), result.latencies_us.end());
+    }
+    return total;
+}
+
+// 异步模式：单个 AsyncRPCClient 保持 in_flight 个调用在途，每完成一个立即发出下一个（闭环）
+BenchResult runAsync(const std::string& endpoint, RpcEncoding encoding, int in_flight,
+                     int payload, Clock::time_point start, Clock::time_point deadline) {
+    AsyncRPCClient client(endpoint, std::chrono::seconds(30), static_cast<size_t>(in_flight), encoding);
+    BenchResult result;
+    std::mutex mutex;
+    std::condition_variable done;
+    int outstanding = in_flight;
+
+    // 回调在客户端的收发线程上执行，result 只在该线程上修改，结束后经 mutex 交给调用线程
+    std::function<void()> issue = [&]() {
+        auto start = Clock::now();
+        auto callback = [&, start](const json&, std::exception_ptr error) {
+            result.latencies_us.push_back(elapsedUs(start));
+            if (error) {
+                ++result.errors;
+            } else {
+                ++result.calls;
+            }
+            if (Clock::now() < deadline) {
+                issue();
+                return;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--outstanding == 0) {
+                done.notify_one();
+            }
+        };
+        if (payload > 0) {
+            client.callAsyncThen(callback, std::chrono::seconds(30), "getProcessList", payload);
+        } else {
+            client.callAsyncThen(callback, std::chrono::seconds(30), "add", 1, 2);
+        }
+    };
+    for (int i = 0; i < in_flight; ++i) {
+        issue();
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&]() { return outstanding == 0; });
+    // 不计入客户端析构（等待收发线程退出）的时间
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return result;
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void printHeader() {
+    std::cout << std::left
+              << std::setw(6) << "trans" << std::setw(9) << "server" << std::setw(7) << "client"
+              << std::setw(9) << "encoding" << std::right
+              << std::setw(6) << "conc" << std::setw(8) << "payload"
+              << std::setw(10) << "calls" << std::setw(8) << "errors" << std::setw(12) << "calls/s"
+              << std::setw(10) << "p50(us)" << std::setw(10) << "p90(us)" << std::setw(10) << "p99(us)"
+              << std::setw(10) << "max(us)" << std::endl;
+}
+
+void printResult(const std::string& transport, const std::string& server, const std::string& client,
+                 const std::string& encoding, int concurrency, int payload, BenchResult& result) {
+    std::sort(result.latencies_us.begin(), result.latencies_us.end());
+    const double rate = result.seconds > 0 ? result.calls / result.seconds : 0;
+    std::cout << std::left
+              << std::setw(6) << transport << std::setw(9) << server << std::setw(7) << client
+              << std::setw(9) << encoding << std::right
+              << std::setw(6) << concurrency << std::setw(8) << payload
+              << std::setw(10) << result.calls << std::setw(8) << result.errors
+              << std::setw(12) << std::fixed << std::setprecision(0) << rate
+              << std::setw(10) << percentile(result.latencies_us, 0.50)
+              << std::setw(10) << percentile(result.latencies_us, 0.90)
+              << std::setw(10) << percentile(result.latencies_us, 0.99)
+              << std::setw(10) << (result.latencies_us.empty() ? 0.0 : result.latencies_us.back())
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        return 1;
+    }
+
+    std::cout << "RPC基准测试: 每个场景 " << config.duration_ms << "ms，多线程服务端 "
+              << config.workers << " 个工作线程，批大小 " << config.batch
+              << "，流分段大小 " << config.chunk << std::endl;
+    printHeader();
+
+    int port = 5650;
+    for (const auto& transport : config.transports) {
+        for (const auto& server_mode : config.servers) {
+            std::string endpoint;
+            if (transport == "tcp") {
+                endpoint = "tcp://127.0.0.1:" + std::to_string(port++);
+            } else {
+                endpoint = "ipc:///tmp/bench-rpc-" + std::to_string(getpid()) + "-" + server_mode;
+            }
+            const size_t workers = server_mode == "workers" ? static_cast<size_t>(config.workers) : 0;
+
+            try {
+                BenchServer server(endpoint, workers, config.payloads, config.chunk);
+                for (const auto& client_mode : config.clients) {
+                    for (const auto& encoding_name : config.encodings) {
+                        RpcEncoding encoding = encoding_name == "msgpack" ? RpcEncoding::MSGPACK : RpcEncoding::JSON;
+                        for (int concurrency : config.concurrency) {
+                            for (int payload : config.payloads) {
+                                if (client_mode == "stream" && payload <= 0) {
+                                    continue;
+                                }
+                                auto start = Clock::now();
+                                auto deadline = start + std::chrono::milliseconds(config.duration_ms);
+                                BenchResult result;
+                                if (client_mode == "async") {
+                                    result = runAsync(endpoint, encoding, concurrency, payload, start, deadline);
+                                } else if (client_mode == "stream") {
+                                    result = runStream(endpoint, encoding, concurrency, payload, start, deadline);
+                                } else {
+                                    int batch_size = client_mode == "batch" ? config.batch : 1;
+                                    result = runSync(endpoint, encoding, concurrency, payload, batch_size, start, deadline);
+                                }
+                                printResult(transport, server_mode, client_mode, encoding_name,
+                                            concurrency, payload, result);
+                            }
+                        }
+                    }
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "基准测试错误 (" << endpoint << "): " << e.what() << std::endl;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
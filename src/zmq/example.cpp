@@ -35,12 +35,12 @@ public:
 private:
     void registerMethods() {
         // 注册RPC方法
-        server_->registerMethod("add", std::function<json(int,int)>(&RPCCalculator::add, this));
-        server_->registerMethod("subtract", std::function<json(int,int)>(&RPCCalculator::subtract, this));
-        server_->registerMethod("multiply", std::function<json(int,int)>(&RPCCalculator::multiply, this));
-        server_->registerMethod("divide", std::function<json(int,int)>(&RPCCalculator::divide, this));
-        server_->registerMethod("getSystemInfo", std::function<json()>(&RPCCalculator::getSystemInfo, this));
-        server_->registerMethod("getProcessList", std::function<json()>(&RPCCalculator::getProcessList, this));
+        server_->registerMethod("add", [this](int a, int b) { return add(a, b); });
+        server_->registerMethod("subtract", [this](int a, int b) { return subtract(a, b); });
+        server_->registerMethod("multiply", [this](int a, int b) { return multiply(a, b); });
+        server_->registerMethod("divide", [this](int a, int b) { return divide(a, b); });
+        server_->registerMethod("getSystemInfo", [this]() { return getSystemInfo(); });
+        server_->registerMethod("getProcessList", [this]() { return getProcessList(); });
     }
 
     // RPC方法实现
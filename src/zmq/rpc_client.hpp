@@ -5,15 +5,97 @@
 #include <functional>
 #include <nlohmann/json.hpp>
 #include <sstream>
+#include <iostream>
 #include <stdexcept>
 #include <vector>
 #include <tuple>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <exception>
+#include "rpc_codec.hpp"
 
 using json = nlohmann::json;
 
 class RPCClient {
 public:
-    explicit RPCClient(const std::string& endpoint) {
+    // 流式调用的结果：逐个取出元素，当前一段取完时才向服务端拉取下一段，
+    // 因此同时只持有一段结果，拉取的快慢由调用方的处理速度决定。
+    // 拉取使用所属 RPCClient 的套接字，Stream 不应比 RPCClient 存活更久
+    class Stream {
+    public:
+        Stream(Stream&& other) noexcept
+            : client_(other.client_), stream_id_(std::move(other.stream_id_)),
+              items_(std::move(other.items_)), index_(other.index_), done_(other.done_) {
+            other.client_ = nullptr;
+        }
+        Stream(const Stream&) = delete;
+        Stream& operator=(const Stream&) = delete;
+        Stream& operator=(Stream&&) = delete;
+
+        // 未取完就销毁时通知服务端释放该流
+        ~Stream() {
+            close();
+        }
+
+        // 取下一个元素，没有更多元素时返回false
+        bool next(json& item) {
+            while (index_ >= items_.size()) {
+                if (done_ || !client_) {
+                    return false;
+                }
+                load(client_->call("rpc.stream.next", stream_id_));
+            }
+            item = std::move(items_[index_++]);
+            return true;
+        }
+
+        // 提前结束
+        void close() {
+            if (!done_ && client_) {
+                done_ = true;
+                try {
+                    client_->call("rpc.stream.close", stream_id_);
+                } catch (const std::exception& e) {
+                    std::cerr << "RPC stream close failed: " << e.what() << std::endl;
+                }
+            }
+        }
+
+    private:
+        friend class RPCClient;
+
+        Stream(RPCClient* client, json first) : client_(client) {
+            load(std::move(first));
+        }
+
+        void load(json chunk) {
+            if (!chunk.is_object() || !chunk.contains("items") || !chunk["items"].is_array()) {
+                done_ = true;
+                throw std::runtime_error("RPC error: not a stream response");
+            }
+            items_ = std::move(chunk["items"]);
+            index_ = 0;
+            done_ = chunk.value("done", true);
+            stream_id_ = chunk["stream"];
+        }
+
+        RPCClient* client_;
+        json stream_id_;
+        json items_;
+        size_t index_ = 0;
+        bool done_ = false;
+    };
+
+    // encoding 为请求使用的编码，服务端以同样的编码应答
+    explicit RPCClient(const std::string& endpoint, RpcEncoding encoding = RpcEncoding::JSON)
+        : encoding_(encoding) {
         context_ = std::make_unique<zmq::context_t>(1);
         socket_ = std::make_unique<zmq::socket_t>(*context_, ZMQ_REQ);
         socket_->connect(endpoint);
@@ -30,19 +112,7 @@ public:
         // 使用辅助函数来序列化参数
         serializeArgs(request["params"], std::forward<Args>(args)...);
 
-        std::string request_str = request.dump();
-        zmq::message_t request_msg(request_str.size());
-        memcpy(request_msg.data(), request_str.c_str(), request_str.size());
-        socket_->send(request_msg, zmq::send_flags::none);
-
-        zmq::message_t reply;
-        auto result = socket_->recv(reply);
-        if (!result) {
-            throw std::runtime_error("Failed to receive response");
-        }
-
-        std::string reply_str(static_cast<char*>(reply.data()), reply.size());
-        json response = json::parse(reply_str);
+        json response = roundTrip(request);
 
         if (response.contains("error") && !response["error"].is_null()) {
             throw std::runtime_error("RPC error: " + response["error"]["message"].get<std::string>());
@@ -51,11 +121,80 @@ public:
         return response["result"];
     }
 
+    // 调用以 registerStreamMethod 注册的流式方法，返回的 Stream 按需拉取后续结果
+    template<typename... Args>
+    Stream callStream(const std::string& method, Args&&... args) {
+        return Stream(this, call(method, std::forward<Args>(args)...));
+    }
+
+    // 通知：服务端执行方法但不返回结果
+    template<typename... Args>
+    void notify(const std::string& method, Args&&... args) {
+        json request;
+        request["jsonrpc"] = "2.0";
+        request["method"] = method;
+        request["params"] = json::array();
+        serializeArgs(request["params"], std::forward<Args>(args)...);
+        roundTrip(request);
+    }
+
+    // 批调用：calls 为 (方法名, 参数数组)，一次往返发送全部请求。
+    // 返回与 calls 顺序一致的应答对象，各自含 result 或 error，单个请求失败不影响其他请求
+    json callBatch(const std::vector<std::pair<std::string, json>>& calls) {
+        if (calls.empty()) {
+            return json::array();
+        }
+        const int first_id = next_id_;
+        json batch = json::array();
+        for (const auto& call : calls) {
+            batch.push_back({
+                {"jsonrpc", "2.0"},
+                {"method", call.first},
+                {"params", call.second},
+                {"id", next_id_++}
+            });
+        }
+
+        json response = roundTrip(batch);
+        if (!response.is_array()) {
+            // 整批无效时服务端返回单个错误对象
+            throw std::runtime_error("RPC error: " + response["error"]["message"].get<std::string>());
+        }
+        // 批应答的顺序不保证与请求一致，按 id 还原
+        json ordered = json::array();
+        for (size_t i = 0; i < calls.size(); ++i) {
+            ordered.push_back(nullptr);
+        }
+        for (auto& item : response) {
+            if (item.contains("id") && item["id"].is_number_integer()) {
+                size_t index = static_cast<size_t>(item["id"].get<int>() - first_id);
+                if (index < ordered.size()) {
+                    ordered[index] = std::move(item);
+                }
+            }
+        }
+        return ordered;
+    }
+
 private:
     std::unique_ptr<zmq::context_t> context_;
     std::unique_ptr<zmq::socket_t> socket_;
+    RpcEncoding encoding_;
     int next_id_ = 1;
 
+    // 发送请求并等待应答；通知的应答为空消息，返回 null
+    json roundTrip(const json& request) {
+        zmq::message_t request_msg = rpc_codec::encode(request, encoding_);
+        socket_->send(request_msg, zmq::send_flags::none);
+
+        zmq::message_t reply;
+        auto result = socket_->recv(reply);
+        if (!result) {
+            throw std::runtime_error("Failed to receive response");
+        }
+        return rpc_codec::decode(reply);
+    }
+
     // 辅助函数：序列化单个参数
     template<typename T>
     void serializeArg(json& params, T&& arg) {
@@ -77,4 +216,304 @@ private:
     json serializeValue(T&& value) {
         return json(std::forward<T>(value));
     }
-}; 
\ No newline at end of file
+}; 
+
+// 异步流水线RPC客户端
+// 基于 DEALER 套接字，可同时有多个调用在途，按 JSON-RPC 的 id 关联应答；
+// 兼容单线程（REP）与多线程（ROUTER）两种模式的 RPCServer。
+// 调用方线程只把请求交给后台收发线程（经 inproc PUSH/PULL），由后台线程独占 DEALER 套接字，
+// 负责发送、接收、按 id 完成 future 或回调，以及处理每个调用各自的超时。
+// 服务端的 ROUTER/REP 在应答队列达到高水位时会静默丢弃应答，因此已发出未应答的请求数
+// 不超过 max_in_flight，其余请求在客户端排队，有应答或超时后再依次发出。
+// encoding 为请求使用的编码（见 RpcEncoding），服务端以同样的编码应答。
+class AsyncRPCClient {
+public:
+    // result 仅在 error 为空时有效；回调在后台收发线程上执行，不应阻塞。
+    // 回调抛出的异常被捕获并记录，不影响收发线程
+    using Callback = std::function<void(const json& result, std::exception_ptr error)>;
+
+    explicit AsyncRPCClient(const std::string& endpoint,
+                            std::chrono::milliseconds default_timeout = std::chrono::seconds(30),
+                            size_t max_in_flight = 256,
+                            RpcEncoding encoding = RpcEncoding::JSON)
+        : default_timeout_(default_timeout), max_in_flight_(max_in_flight == 0 ? 1 : max_in_flight),
+          encoding_(encoding) {
+        context_ = std::make_unique<zmq::context_t>(1);
+        std::ostringstream inbox;
+        inbox << "inproc://rpc-client-" << static_cast<const void*>(this);
+
+        dealer_ = std::make_unique<zmq::socket_t>(*context_, ZMQ_DEALER);
+        dealer_->set(zmq::sockopt::linger, 0);
+        dealer_->connect(endpoint);
+        inbox_ = std::make_unique<zmq::socket_t>(*context_, ZMQ_PULL);
+        inbox_->bind(inbox.str());
+        outbox_ = std::make_unique<zmq::socket_t>(*context_, ZMQ_PUSH);
+        outbox_->connect(inbox.str());
+
+        running_ = true;
+        io_thread_ = std::thread(&AsyncRPCClient::run, this);
+    }
+
+    ~AsyncRPCClient() {
+        stop();
+        outbox_.reset();
+    }
+
+    // 停止收发线程，未完成的调用以 "RPC client closed" 失败；
+    // 之后提交的调用在提交时即以同样的错误失败。不能在回调内调用
+    void stop() {
+        running_ = false;
+        if (io_thread_.joinable()) {
+            io_thread_.join();
+        }
+    }
+
+    template<typename... Args>
+    std::future<json> callAsync(const std::string& method, Args&&... args) {
+        return callAsyncFor(default_timeout_, method, std::forward<Args>(args)...);
+    }
+
+    // 指定本次调用的超时（从提交时起算，包括在客户端排队的时间），超时后 future 抛出 std::runtime_error
+    template<typename... Args>
+    std::future<json> callAsyncFor(std::chrono::milliseconds timeout, const std::string& method, Args&&... args) {
+        auto promise = std::make_shared<std::promise<json>>();
+        std::future<json> future = promise->get_future();
+        submit(method, json::array({json(std::forward<Args>(args))...}), timeout,
+               [promise](const json& result, std::exception_ptr error) {
+                   if (error) {
+                       promise->set_exception(error);
+                   } else {
+                       promise->set_value(result);
+                   }
+               });
+        return future;
+    }
+
+    template<typename... Args>
+    void callAsyncThen(Callback callback, std::chrono::milliseconds timeout, const std::string& method, Args&&... args) {
+        submit(method, json::array({json(std::forward<Args>(args))...}), timeout, std::move(callback));
+    }
+
+    // 未完成（排队或在途）的调用数
+    size_t pendingCount() {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        return pending_.size();
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Pending {
+        std::string method;
+        Callback callback;
+        std::multimap<Clock::time_point, int>::iterator deadline;
+        bool sent = false;   // 已发往服务端，占用一个在途名额
+    };
+
+    std::unique_ptr<zmq::context_t> context_;
+    std::unique_ptr<zmq::socket_t> dealer_;   // 仅后台线程使用
+    std::unique_ptr<zmq::socket_t> inbox_;    // 仅后台线程使用
+    std::unique_ptr<zmq::socket_t> outbox_;   // 调用方线程共用，受 outbox_mutex_ 保护
+    std::mutex outbox_mutex_;
+    bool closed_ = false;                     // 收发线程已退出，受 outbox_mutex_ 保护
+    std::chrono::milliseconds default_timeout_;
+    size_t max_in_flight_;
+    RpcEncoding encoding_;
+    std::atomic<int> next_id_{1};
+    std::atomic<bool> running_{false};
+    std::thread io_thread_;
+
+    // 以下两项仅后台线程使用
+    std::deque<std::pair<int, zmq::message_t>> backlog_;
+    size_t in_flight_ = 0;
+
+    std::mutex pending_mutex_;
+    std::unordered_map<int, Pending> pending_;
+    std::multimap<Clock::time_point, int> deadlines_;
+
+    void submit(const std::string& method, json params, std::chrono::milliseconds timeout, Callback callback) {
+        int id = next_id_++;
+        json request;
+        request["jsonrpc"] = "2.0";
+        request["method"] = method;
+        request["id"] = id;
+        request["params"] = std::move(params);
+
+        // 请求体在调用方线程编码，经 inproc 转交给收发线程时不复制
+        zmq::message_t body = rpc_codec::encode(request, encoding_);
+
+        std::unique_lock<std::mutex> outbox_lock(outbox_mutex_);
+        if (closed_) {
+            // 收发线程已退出，不会再处理该调用
+            outbox_lock.unlock();
+            complete(callback, json(), std::make_exception_ptr(std::runtime_error("RPC client closed")));
+            return;
+        }
+        // 先登记再发送，避免应答先于登记到达
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            auto deadline = deadlines_.emplace(Clock::now() + timeout, id);
+            Pending pending;
+            pending.method = method;
+            pending.callback = std::move(callback);
+            pending.deadline = deadline;
+            pending_.emplace(id, std::move(pending));
+        }
+        // 两帧：请求 id 与请求体，收发线程据 id 管理排队与在途名额
+        outbox_->send(zmq::buffer(&id, sizeof(id)), zmq::send_flags::sndmore);
+        outbox_->send(body, zmq::send_flags::none);
+    }
+
+    // 执行调用方的回调，异常不能逃出收发线程
+    static void complete(const Callback& callback, const json& result, std::exception_ptr error) {
+        try {
+            callback(result, error);
+        } catch (const std::exception& e) {
+            std::cerr << "RPC callback error: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "RPC callback error: unknown exception" << std::endl;
+        }
+    }
+
+    // 取出一个未完成的调用；id 不存在（已超时或重复应答）时返回false
+    bool take(int id, Pending& out) {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        auto it = pending_.find(id);
+        if (it == pending_.end()) {
+            return false;
+        }
+        out = std::move(it->second);
+        deadlines_.erase(out.deadline);
+        pending_.erase(it);
+        return true;
+    }
+
+    void handleReply(const zmq::message_t& reply) {
+        json response;
+        try {
+            response = rpc_codec::decode(reply);
+        } catch (const json::parse_error& e) {
+            std::cerr << "Invalid RPC response: " << e.what() << std::endl;
+            return;
+        }
+        if (!response.contains("id") || !response["id"].is_number_integer()) {
+            return;
+        }
+        Pending pending;
+        if (!take(response["id"].get<int>(), pending)) {
+            return;
+        }
+        --in_flight_;
+        if (response.contains("error") && !response["error"].is_null()) {
+            complete(pending.callback, json(), std::make_exception_ptr(std::runtime_error(
+                "RPC error: " + response["error"].value("message", std::string("unknown error")))));
+        } else {
+            complete(pending.callback, response["result"], nullptr);
+        }
+    }
+
+    // 使到期的调用失败，返回距下一个到期时间的间隔（最长100ms，以便及时发现停止请求）
+    std::chrono::milliseconds expireDeadlines() {
+        const auto max_wait = std::chrono::milliseconds(100);
+        std::vector<Pending> expired;
+        std::chrono::milliseconds wait = max_wait;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            const auto now = Clock::now();
+            while (!deadlines_.empty() && deadlines_.begin()->first <= now) {
+                auto it = pending_.find(deadlines_.begin()->second);
+                expired.push_back(std::move(it->second));
+                pending_.erase(it);
+                deadlines_.erase(deadlines_.begin());
+            }
+            if (!deadlines_.empty()) {
+                auto next = std::chrono::duration_cast<std::chrono::milliseconds>(deadlines_.begin()->first - now);
+                wait = std::min(max_wait, next + std::chrono::milliseconds(1));
+            }
+        }
+        for (const auto& item : expired) {
+            // 已发出的请求即使之后收到应答也会被忽略，名额在此释放
+            if (item.sent) {
+                --in_flight_;
+            }
+            complete(item.callback, json(), std::make_exception_ptr(std::runtime_error("RPC timeout: " + item.method)));
+        }
+        return wait;
+    }
+
+    // 在名额允许的范围内发出排队的请求，跳过已超时的
+    void sendBacklog() {
+        while (in_flight_ < max_in_flight_ && !backlog_.empty()) {
+            int id = backlog_.front().first;
+            zmq::message_t request = std::move(backlog_.front().second);
+            backlog_.pop_front();
+            {
+                std::lock_guard<std::mutex> lock(pending_mutex_);
+                auto it = pending_.find(id);
+                if (it == pending_.end()) {
+                    continue;
+                }
+                it->second.sent = true;
+            }
+            // REP 端要求空的分隔帧
+            dealer_->send(zmq::message_t(), zmq::send_flags::sndmore);
+            dealer_->send(request, zmq::send_flags::none);
+            ++in_flight_;
+        }
+    }
+
+    void run() {
+        while (running_) {
+            std::chrono::milliseconds wait = expireDeadlines();
+            zmq::pollitem_t items[] = {
+                {static_cast<void*>(*dealer_), 0, ZMQ_POLLIN, 0},
+                {static_cast<void*>(*inbox_), 0, ZMQ_POLLIN, 0}
+            };
+            try {
+                zmq::poll(items, 2, wait);
+                // 一次唤醒处理完所有已到达的消息
+                if (items[0].revents & ZMQ_POLLIN) {
+                    zmq::message_t frame;
+                    while (dealer_->recv(frame, zmq::recv_flags::dontwait)) {
+                        if (frame.more()) {
+                            continue; // 跳过分隔帧
+                        }
+                        handleReply(frame);
+                    }
+                }
+                if (items[1].revents & ZMQ_POLLIN) {
+                    zmq::message_t id;
+                    while (inbox_->recv(id, zmq::recv_flags::dontwait)) {
+                        zmq::message_t request;
+                        if (!inbox_->recv(request, zmq::recv_flags::none)) {
+                            break;
+                        }
+                        backlog_.emplace_back(*id.data<int>(), std::move(request));
+                    }
+                }
+                sendBacklog();
+            } catch (const zmq::error_t& e) {
+                std::cerr << "RPC client error: " << e.what() << std::endl;
+            }
+        }
+
+        // 关闭前使所有未完成的调用失败；置 closed_ 后不再有新的调用登记
+        std::vector<Pending> remaining;
+        {
+            std::lock_guard<std::mutex> outbox_lock(outbox_mutex_);
+            closed_ = true;
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            for (auto& pair : pending_) {
+                remaining.push_back(std::move(pair.second));
+            }
+            pending_.clear();
+            deadlines_.clear();
+        }
+        for (const auto& item : remaining) {
+            complete(item.callback, json(), std::make_exception_ptr(std::runtime_error("RPC client closed")));
+        }
+        backlog_.clear();
+        dealer_.reset();
+        inbox_.reset();
+    }
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <zmq.hpp>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// RPC消息的编码方式。
+// 客户端在构造时选定编码，服务端按每个请求的首字节识别并以同样的编码应答，
+// 因此同一连接上无需额外的握手，新旧客户端可以连接同一个服务端。
+enum class RpcEncoding {
+    JSON,       // JSON 文本
+    MSGPACK     // MessagePack 二进制，体积更小、编解码更快，适合进程列表等大结果
+};
+
+namespace rpc_codec {
+
+// 按首字节识别编码：请求/应答总是对象或数组，MessagePack 的 map/array 标记
+// （0x80-0x9f、0xdc-0xdf）不可能是 JSON 文本的首字符
+inline RpcEncoding detectEncoding(const zmq::message_t& message) {
+    if (message.size() == 0) {
+        return RpcEncoding::JSON;
+    }
+    const uint8_t first = *message.data<uint8_t>();
+    if ((first >= 0x80 && first <= 0x9f) || (first >= 0xdc && first <= 0xdf)) {
+        return RpcEncoding::MSGPACK;
+    }
+    return RpcEncoding::JSON;
+}
+
+// 直接从消息缓冲区解析，不复制；空消息返回 null。
+// 格式错误时抛出 json::parse_error
+inline json decode(const zmq::message_t& message) {
+    if (message.size() == 0) {
+        return json();
+    }
+    const uint8_t* begin = message.data<uint8_t>();
+    const uint8_t* end = begin + message.size();
+    if (detectEncoding(message) == RpcEncoding::MSGPACK) {
+        return json::from_msgpack(begin, end);
+    }
+    return json::parse(begin, end);
+}
+
+namespace detail {
+    template<typename Buffer>
+    void freeBuffer(void* /*data*/, void* hint) {
+        delete static_cast<Buffer*>(hint);
+    }
+}
+
+// 序列化到堆上的缓冲区，并把缓冲区的所有权交给消息，由 ZeroMQ 在发送完成后释放，
+// 不再经过 std::string 中转和 memcpy
+inline zmq::message_t encode(const json& value, RpcEncoding encoding) {
+    if (encoding == RpcEncoding::MSGPACK) {
+        auto* buffer = new std::vector<uint8_t>();
+        json::to_msgpack(value, *buffer);
+        return zmq::message_t(buffer->data(), buffer->size(),
+                              &detail::freeBuffer<std::vector<uint8_t>>, buffer);
+    }
+    auto* buffer = new std::string(value.dump());
+    return zmq::message_t(&(*buffer)[0], buffer->size(),
+                          &detail::freeBuffer<std::string>, buffer);
+}
+
+} // namespace rpc_codec
@@ -2,48 +2,45 @@
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <future>
+#include <algorithm>
 
 namespace {
-    // 辅助函数：从JSON中提取参数
-    template<typename T>
-    T deserializeArg(const json& value) {
-        return value.get<T>();
-    }
-
-    // 辅助函数：调用无参数的处理函数
-    json callHandlerImpl(std::function<json()> handler, const json& params) {
-        if (!params.empty()) {
-            throw std::runtime_error("参数数量不匹配");
-        }
-        return handler();
-    }
-
-    // 辅助函数：调用单参数的处理函数
-    template<typename T>
-    json callHandlerImpl(std::function<json(T)> handler, const json& params) {
-        if (params.size() != 1) {
-            throw std::runtime_error("参数数量不匹配");
-        }
-        return handler(deserializeArg<T>(params[0]));
-    }
+    // 阻塞在 recv 上的线程无法感知停止请求，服务循环以该间隔轮询
+    const std::chrono::milliseconds kPollInterval(100);
 
-    // 辅助函数：调用双参数的处理函数
-    template<typename T1, typename T2>
-    json callHandlerImpl(std::function<json(T1, T2)> handler, const json& params) {
-        if (params.size() != 2) {
-            throw std::runtime_error("参数数量不匹配");
+    // 把一条（可能多帧的）消息原样从一个套接字转发到另一个
+    void forwardMessage(zmq::socket_t& from, zmq::socket_t& to) {
+        while (true) {
+            zmq::message_t part;
+            if (!from.recv(part, zmq::recv_flags::none)) {
+                return;
+            }
+            bool more = part.more();
+            if (!to.send(part, more ? zmq::send_flags::sndmore : zmq::send_flags::none) || !more) {
+                return;
+            }
         }
-        return handler(deserializeArg<T1>(params[0]), deserializeArg<T2>(params[1]));
     }
 }
 
-RPCServer::RPCServer(const std::string& endpoint) 
-    : context_(1), socket_(context_, ZMQ_REP) {
+RPCServer::RPCServer(const std::string& endpoint, size_t worker_count)
+    : context_(1), socket_(context_, worker_count > 0 ? ZMQ_ROUTER : ZMQ_REP), worker_count_(worker_count) {
     try {
         socket_.bind(endpoint);
     } catch (const zmq::error_t& e) {
         throw std::runtime_error("Failed to bind socket: " + std::string(e.what()));
     }
+    std::ostringstream backend;
+    backend << "inproc://rpc-workers-" << static_cast<const void*>(this);
+    backend_endpoint_ = backend.str();
+
+    // 流式方法的后续拉取与提前结束
+    registerMethod("rpc.stream.next", [this](uint64_t stream_id) { return nextStreamChunk(stream_id); });
+    registerMethod("rpc.stream.close", [this](uint64_t stream_id) { return closeStream(stream_id); });
 }
 
 RPCServer::~RPCServer() {
@@ -51,73 +48,316 @@ RPCServer::~RPCServer() {
 }
 
 void RPCServer::start() {
-    running_ = true;
-    while (running_) {
+    {
+        // stop 可能先于 start 执行（如服务线程尚未调度到），此时不再进入服务循环
+        std::lock_guard<std::mutex> lock(serving_mutex_);
+        if (serving_ || stop_requested_) {
+            return;
+        }
+        serving_ = true;
+        running_ = true;
+    }
+    if (worker_count_ > 0) {
+        runBroker();
+    } else {
+        serve(socket_, running_);
+    }
+    {
+        std::lock_guard<std::mutex> lock(serving_mutex_);
+        serving_ = false;
+    }
+    serving_cv_.notify_all();
+}
+
+void RPCServer::stop() {
+    std::unique_lock<std::mutex> lock(serving_mutex_);
+    stop_requested_ = true;
+    running_ = false;
+    serving_cv_.wait(lock, [this] { return !serving_; });
+}
+
+void RPCServer::runBroker() {
+    zmq::socket_t backend(context_, ZMQ_DEALER);
+    backend.bind(backend_endpoint_);
+
+    workers_running_ = true;
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < worker_count_; ++i) {
+        workers.emplace_back(&RPCServer::runWorker, this);
+    }
+
+    // in_flight 为已转给工作线程、尚未应答的请求数；停止后不再接收新请求，
+    // 但继续转发应答直到其归零，工作线程才能退出而不丢弃已排队的请求
+    size_t in_flight = 0;
+    while (running_ || in_flight > 0) {
+        zmq::pollitem_t items[] = {
+            {static_cast<void*>(backend), 0, ZMQ_POLLIN, 0},
+            {static_cast<void*>(socket_), 0, ZMQ_POLLIN, 0}
+        };
         try {
+            zmq::poll(items, running_ ? 2 : 1, kPollInterval);
+            if (items[0].revents & ZMQ_POLLIN) {
+                forwardMessage(backend, socket_);
+                --in_flight;
+            }
+            if (items[1].revents & ZMQ_POLLIN) {
+                forwardMessage(socket_, backend);
+                ++in_flight;
+            }
+        } catch (const zmq::error_t& e) {
+            std::cerr << "Error forwarding request: " << e.what() << std::endl;
+            break;
+        }
+    }
+
+    workers_running_ = false;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void RPCServer::runWorker() {
+    zmq::socket_t socket(context_, ZMQ_REP);
+    socket.connect(backend_endpoint_);
+    serve(socket, workers_running_);
+}
+
+void RPCServer::serve(zmq::socket_t& socket, const std::atomic<bool>& keep_running) {
+    while (true) {
+        RpcEncoding encoding = RpcEncoding::JSON;
+        try {
+            zmq::pollitem_t item = {static_cast<void*>(socket), 0, ZMQ_POLLIN, 0};
+            zmq::poll(&item, 1, kPollInterval);
+            if (!(item.revents & ZMQ_POLLIN)) {
+                if (!keep_running) {
+                    break;
+                }
+                continue;
+            }
+
             zmq::message_t request;
-            auto result = socket_.recv(request, zmq::recv_flags::none);
+            auto result = socket.recv(request, zmq::recv_flags::none);
             if (!result) {
                 continue;
             }
 
-            std::string request_str(static_cast<char*>(request.data()), request.size());
-            json response = handleRequest(request_str);
+            // 按请求的编码应答；请求直接从消息缓冲区解析
+            encoding = rpc_codec::detectEncoding(request);
+            json response = handleRequest(request);
 
-            std::string response_str = response.dump();
-            zmq::message_t reply(response_str.size());
-            memcpy(reply.data(), response_str.data(), response_str.size());
-            socket_.send(reply, zmq::send_flags::none);
+            // REP 套接字必须逐个应答，通知（或全为通知的批）以空消息应答
+            zmq::message_t reply = response.is_null() ? zmq::message_t()
+                                                      : rpc_codec::encode(response, encoding);
+            socket.send(reply, zmq::send_flags::none);
+        } catch (const zmq::error_t& e) {
+            std::cerr << "Error handling request: " << e.what() << std::endl;
+            break;
         } catch (const std::exception& e) {
             std::cerr << "Error handling request: " << e.what() << std::endl;
-            json error_response = createErrorResponse(-32000, "Internal error: " + std::string(e.what()));
-            std::string error_str = error_response.dump();
-            zmq::message_t reply(error_str.size());
-            memcpy(reply.data(), error_str.data(), error_str.size());
-            socket_.send(reply, zmq::send_flags::none);
+            // 发送错误应答本身也可能失败（如停止时上下文已终止），不能让异常逃出工作线程
+            try {
+                json error_response = createErrorResponse(-32000, "Internal error: " + std::string(e.what()));
+                zmq::message_t reply = rpc_codec::encode(error_response, encoding);
+                socket.send(reply, zmq::send_flags::none);
+            } catch (const std::exception& send_error) {
+                std::cerr << "Error sending error response: " << send_error.what() << std::endl;
+                break;
+            }
         }
     }
 }
 
-void RPCServer::stop() {
-    running_ = false;
-    socket_.close();
+json RPCServer::handleRequest(const zmq::message_t& message) {
+    json request;
+    try {
+        request = rpc_codec::decode(message);
+    } catch (const json::parse_error& e) {
+        return createErrorResponse(-32700, "Parse error: " + std::string(e.what()));
+    }
+    if (!request.is_array()) {
+        return handleCall(request);
+    }
+    if (request.empty()) {
+        return createErrorResponse(-32600, "Invalid Request: empty batch");
+    }
+    return handleBatch(request);
+}
+
+json RPCServer::handleBatch(const json& batch) {
+    std::vector<json> responses(batch.size());
+    auto process = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            responses[i] = handleCall(batch[i], true);
+        }
+    };
+
+    const size_t count = batch.size();
+    const size_t tasks = std::min(batch_concurrency_, count);
+    if (tasks > 1) {
+        // 批内各请求相互独立，按连续区间分给多个线程，调用线程处理第一段
+        const size_t chunk = (count + tasks - 1) / tasks;
+        std::vector<std::future<void>> futures;
+        for (size_t begin = chunk; begin < count; begin += chunk) {
+            futures.push_back(std::async(std::launch::async, process, begin, std::min(count, begin + chunk)));
+        }
+        process(0, std::min(count, chunk));
+        for (auto& future : futures) {
+            future.get();
+        }
+    } else {
+        process(0, count);
+    }
+
+    // 通知没有应答；全部为通知时整批不应答
+    json reply = json::array();
+    for (auto& response : responses) {
+        if (!response.is_null()) {
+            reply.push_back(std::move(response));
+        }
+    }
+    return reply.empty() ? json() : reply;
 }
 
-json RPCServer::handleRequest(const std::string& request_str) {
+json RPCServer::handleCall(const json& request, bool in_batch) {
+    // 验证请求格式
+    if (!request.is_object() || !request.contains("jsonrpc") || !request.contains("method") ||
+        !request["method"].is_string()) {
+        return createErrorResponse(-32600, "Invalid Request");
+    }
+
+    // 不带 id 的请求是通知：照常执行，但不产生应答
+    const bool notification = !request.contains("id");
+    json id = notification ? json() : request["id"];
+
+    if (request["jsonrpc"] != "2.0") {
+        return notification ? json() : createErrorResponse(-32600, "Invalid Request: jsonrpc must be '2.0'", id);
+    }
+
+    std::string method = request["method"];
+    json params = request.value("params", json::array());
+
+    // 查找并调用处理方法
+    auto it = handlers_.find(method);
+    if (it == handlers_.end()) {
+        return notification ? json() : createErrorResponse(-32601, "Method not found: " + method, id);
+    }
+
+    // 流式方法不执行，以免创建无人拉取的流
+    if (stream_methods_.count(method) > 0 && (notification || in_batch)) {
+        return notification ? json() : createErrorResponse(-32600,
+            "Invalid Request: stream method " + method + " cannot be called in a batch", id);
+    }
+
     try {
-        json request = json::parse(request_str);
-        
-        // 验证请求格式
-        if (!request.contains("jsonrpc") || !request.contains("method") || !request.contains("id")) {
-            return createErrorResponse(-32600, "Invalid Request");
+        json result = it->second(params);
+        return notification ? json() : createSuccessResponse(result, id);
+    } catch (const std::invalid_argument& e) {
+        return notification ? json() : createErrorResponse(-32602, "Invalid params: " + std::string(e.what()), id);
+    } catch (const std::exception& e) {
+        return notification ? json() : createErrorResponse(-32000, "Internal error: " + std::string(e.what()), id);
+    }
+}
+
+void RPCServer::setBatchConcurrency(size_t concurrency) {
+    batch_concurrency_ = concurrency == 0 ? 1 : concurrency;
+}
+
+void RPCServer::setStreamChunkSize(size_t chunk_size) {
+    stream_chunk_size_ = chunk_size == 0 ? 1 : chunk_size;
+}
+
+void RPCServer::setStreamLimits(size_t max_streams, std::chrono::seconds idle_timeout) {
+    max_streams_ = max_streams;
+    stream_idle_timeout_ = idle_timeout;
+}
+
+json RPCServer::readChunk(StreamProducer& producer, bool& done) {
+    json items = json::array();
+    done = false;
+    while (items.size() < stream_chunk_size_) {
+        json item;
+        if (!producer(item)) {
+            done = true;
+            break;
+        }
+        items.push_back(std::move(item));
+    }
+    return items;
+}
+
+void RPCServer::expireStreams() {
+    const auto now = std::chrono::steady_clock::now();
+    for (auto it = streams_.begin(); it != streams_.end();) {
+        if (now - it->second->last_access > stream_idle_timeout_) {
+            it = streams_.erase(it);
+        } else {
+            ++it;
         }
+    }
+}
 
-        if (request["jsonrpc"] != "2.0") {
-            return createErrorResponse(-32600, "Invalid Request: jsonrpc must be '2.0'");
+json RPCServer::openStream(StreamProducer producer) {
+    if (!producer) {
+        throw std::runtime_error("流式方法未返回生成器");
+    }
+    {
+        std::lock_guard<std::mutex> lock(streams_mutex_);
+        expireStreams();
+        if (streams_.size() >= max_streams_) {
+            throw std::runtime_error("Too many open streams");
         }
+    }
 
-        std::string method = request["method"];
-        json params = request.value("params", json::array());
-        int id = request["id"];
+    bool done = false;
+    json items = readChunk(producer, done);
+    json result = {{"stream", nullptr}, {"items", std::move(items)}, {"done", done}};
+    if (!done) {
+        auto cursor = std::make_shared<StreamCursor>();
+        cursor->producer = std::move(producer);
+        std::lock_guard<std::mutex> lock(streams_mutex_);
+        cursor->last_access = std::chrono::steady_clock::now();
+        const uint64_t stream_id = next_stream_id_++;
+        streams_[stream_id] = std::move(cursor);
+        result["stream"] = stream_id;
+    }
+    return result;
+}
 
-        // 查找并调用处理方法
-        auto it = handlers_.find(method);
-        if (it == handlers_.end()) {
-            return createErrorResponse(-32601, "Method not found: " + method, id);
+json RPCServer::nextStreamChunk(uint64_t stream_id) {
+    std::shared_ptr<StreamCursor> cursor;
+    {
+        std::lock_guard<std::mutex> lock(streams_mutex_);
+        auto it = streams_.find(stream_id);
+        if (it == streams_.end()) {
+            throw std::runtime_error("Unknown or expired stream");
         }
+        cursor = it->second;
+        cursor->last_access = std::chrono::steady_clock::now();
+    }
 
+    bool done = false;
+    json items;
+    {
+        std::lock_guard<std::mutex> cursor_lock(cursor->mutex);
         try {
-            json result = it->second(params);
-            return createSuccessResponse(result, id);
-        } catch (const std::exception& e) {
-            return createErrorResponse(-32000, "Internal error: " + std::string(e.what()), id);
+            items = readChunk(cursor->producer, done);
+        } catch (...) {
+            closeStream(stream_id);
+            throw;
         }
-    } catch (const json::parse_error& e) {
-        return createErrorResponse(-32700, "Parse error: " + std::string(e.what()));
     }
+    if (done) {
+        closeStream(stream_id);
+    }
+    return {{"stream", done ? json() : json(stream_id)}, {"items", std::move(items)}, {"done", done}};
 }
 
-json RPCServer::createErrorResponse(int code, const std::string& message, int id) {
+bool RPCServer::closeStream(uint64_t stream_id) {
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    return streams_.erase(stream_id) > 0;
+}
+
+json RPCServer::createErrorResponse(int code, const std::string& message, const json& id) {
     json response;
     response["jsonrpc"] = "2.0";
     response["error"]["code"] = code;
@@ -126,25 +366,10 @@ json RPCServer::createErrorResponse(int code, const std::string& message, int id
     return response;
 }
 
-json RPCServer::createSuccessResponse(const json& result, int id) {
+json RPCServer::createSuccessResponse(const json& result, const json& id) {
     json response;
     response["jsonrpc"] = "2.0";
     response["result"] = result;
     response["id"] = id;
     return response;
 }
-
-template<typename... Args>
-void RPCServer::registerMethod(const std::string& method_name, 
-                             std::function<json(Args...)> handler) {
-    handlers_[method_name] = [handler](const json& params) -> json {
-        return callHandlerImpl(handler, params);
-    };
-}
-
-// 显式实例化常用的模板
-template void RPCServer::registerMethod<>(const std::string&, std::function<json()>);
-template void RPCServer::registerMethod<int>(const std::string&, std::function<json(int)>);
-template void RPCServer::registerMethod<int, int>(const std::string&, std::function<json(int, int)>);
-template void RPCServer::registerMethod<std::string>(const std::string&, std::function<json(std::string)>);
-template void RPCServer::registerMethod<std::string, int>(const std::string&, std::function<json(std::string, int)>); 
\ No newline at end of file
@@ -4,38 +4,188 @@
 #include <string>
 #include <functional>
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include <chrono>
+#include <cstdint>
 #include <nlohmann/json.hpp>
+#include "rpc_codec.hpp"
 
 using json = nlohmann::json;
 
+namespace rpc_detail {
+    template<typename... Args>
+    struct ArgList {};
+
+    // 从处理函数的类型推导参数列表：函数指针、lambda 及其他带唯一 const operator() 的函数对象
+    template<typename Handler>
+    struct HandlerTraits : HandlerTraits<decltype(&Handler::operator())> {};
+
+    template<typename R, typename... Args>
+    struct HandlerTraits<R(*)(Args...)> {
+        using Arguments = ArgList<Args...>;
+    };
+
+    template<typename C, typename R, typename... Args>
+    struct HandlerTraits<R(C::*)(Args...) const> {
+        using Arguments = ArgList<Args...>;
+    };
+
+    // 按顺序把 params 中的元素转换为各参数类型，类型不符时抛出 std::invalid_argument
+    template<typename Tuple, size_t... I>
+    Tuple convertParams(const json& params, std::index_sequence<I...>) {
+        try {
+            return Tuple{params[I].template get<typename std::tuple_element<I, Tuple>::type>()...};
+        } catch (const json::exception& e) {
+            throw std::invalid_argument(std::string("参数类型不匹配: ") + e.what());
+        }
+    }
+
+    // 返回 handler 的原始返回值，由调用方转换为 json 或流生成器
+    template<typename Handler, typename... Args, size_t... I>
+    auto invokeHandler(const Handler& handler, const json& params, ArgList<Args...>, std::index_sequence<I...> indices) {
+        using Tuple = std::tuple<typename std::decay<Args>::type...>;
+        Tuple args = convertParams<Tuple>(params, indices);
+        (void)args; // 无参数时未被使用
+        return handler(std::get<I>(std::move(args))...);
+    }
+}
+
 class RPCServer {
 public:
-    explicit RPCServer(const std::string& endpoint);
+    // 流式方法返回的生成器：每次调用产生一个元素并返回true，没有更多元素时返回false。
+    // 生成器在多次拉取之间保存状态，可能先后在不同的工作线程上调用，但不会被并发调用
+    using StreamProducer = std::function<bool(json& item)>;
+
+    // worker_count 为0时在 start 的调用线程上用单个 REP 套接字串行处理请求；
+    // 大于0时前端绑定 ROUTER 套接字，经 inproc DEALER 把请求分发给 worker_count 个工作线程，
+    // 每个工作线程有自己的 REP 套接字，共享同一张方法表，慢请求不再阻塞其他调用方
+    explicit RPCServer(const std::string& endpoint, size_t worker_count = 0);
     ~RPCServer();
 
-    // 启动和停止服务器
+    // 启动服务器，阻塞直到 stop 被调用；stop 之后再调用 start 立即返回
     void start();
+    // 停止服务器：不再接收新请求，等待已接收的请求处理完并发出应答后返回。
+    // 可在任意线程调用（处理函数内除外），套接字只由各自的所属线程关闭
     void stop();
 
-    // 注册RPC方法
-    template<typename... Args>
-    void registerMethod(const std::string& method_name, 
-                       std::function<json(Args...)> handler);
+    // 批请求内最多由多少个线程并行处理，默认1（按顺序处理）；须在 start 之前调用
+    void setBatchConcurrency(size_t concurrency);
+
+    // 注册RPC方法，须在 start 之前调用。
+    // handler 可以是函数指针、lambda 或 std::function，参数个数不限，参数类型须能由 json::get 转换
+    // （包括提供了 from_json 的结构体），返回值须能转换为 json。
+    // 多线程模式下 handler 可能被并发调用
+    template<typename Handler>
+    void registerMethod(const std::string& method_name, Handler handler) {
+        using Arguments = typename rpc_detail::HandlerTraits<typename std::decay<Handler>::type>::Arguments;
+        registerHandler(method_name, std::move(handler), Arguments());
+    }
+
+    // 注册流式RPC方法，参数规则同 registerMethod，handler 返回 StreamProducer。
+    // 应答为 {"stream": id, "items": [...], "done": bool}，调用方处理完一段后以
+    // rpc.stream.next(id) 拉取下一段，或以 rpc.stream.close(id) 提前结束。
+    // 服务端只保存每个流的生成器，一次只生成一段，客户端按自己的处理速度拉取即是流量控制。
+    // 流式方法只能单独调用：以通知或在批请求中调用时返回 Invalid Request 且不创建流，
+    // 否则调用方拿不到（或不会处理）流ID，打开的流只能等空闲超时才释放
+    template<typename Handler>
+    void registerStreamMethod(const std::string& method_name, Handler handler) {
+        using Arguments = typename rpc_detail::HandlerTraits<typename std::decay<Handler>::type>::Arguments;
+        registerStreamHandler(method_name, std::move(handler), Arguments());
+    }
+
+    // 每段最多包含的元素数，默认100；须在 start 之前调用
+    void setStreamChunkSize(size_t chunk_size);
+    // 同时打开的流数上限（默认64）与空闲超时（默认60秒），超时未拉取的流被丢弃；须在 start 之前调用
+    void setStreamLimits(size_t max_streams, std::chrono::seconds idle_timeout);
 
 private:
-    // 处理请求
-    json handleRequest(const std::string& request_str);
+    // 参数个数在此检查一次，之后按编译期展开的下标逐个转换参数并直接调用 handler
+    template<typename Handler, typename... Args>
+    void registerHandler(const std::string& method_name, Handler handler, rpc_detail::ArgList<Args...> arguments) {
+        handlers_[method_name] = [handler, arguments](const json& params) -> json {
+            if (!params.is_array() || params.size() != sizeof...(Args)) {
+                throw std::invalid_argument("参数数量不匹配");
+            }
+            return json(rpc_detail::invokeHandler(handler, params, arguments, std::index_sequence_for<Args...>()));
+        };
+    }
+
+    template<typename Handler, typename... Args>
+    void registerStreamHandler(const std::string& method_name, Handler handler, rpc_detail::ArgList<Args...> arguments) {
+        stream_methods_.insert(method_name);
+        handlers_[method_name] = [this, handler, arguments](const json& params) -> json {
+            if (!params.is_array() || params.size() != sizeof...(Args)) {
+                throw std::invalid_argument("参数数量不匹配");
+            }
+            return openStream(rpc_detail::invokeHandler(handler, params, arguments, std::index_sequence_for<Args...>()));
+        };
+    }
+
+    struct StreamCursor {
+        std::mutex mutex;                                  // 防止同一个流被并发拉取
+        StreamProducer producer;
+        std::chrono::steady_clock::time_point last_access; // 受 streams_mutex_ 保护
+    };
+
+    // 生成第一段，未结束时登记为打开的流
+    json openStream(StreamProducer producer);
+    json nextStreamChunk(uint64_t stream_id);
+    bool closeStream(uint64_t stream_id);
+    // 从生成器读取至多 stream_chunk_size_ 个元素
+    json readChunk(StreamProducer& producer, bool& done);
+    // 丢弃空闲超时的流，调用方须持有 streams_mutex_
+    void expireStreams();
+
+    // 处理请求：单个请求对象或 JSON-RPC 2.0 批请求（数组）；
+    // 请求可以是 JSON 文本或 MessagePack（见 rpc_codec.hpp），直接从消息缓冲区解析；
+    // 返回 null 表示无需应答（通知，或全部为通知的批）
+    json handleRequest(const zmq::message_t& message);
+    json handleBatch(const json& batch);
+    // in_batch 为true表示该请求来自批请求
+    json handleCall(const json& request, bool in_batch = false);
+
+    // 在给定的 REP 套接字上循环处理请求，直到 keep_running 为false且没有待处理的请求
+    void serve(zmq::socket_t& socket, const std::atomic<bool>& keep_running);
+    // 多线程模式：前端 ROUTER 与后端 DEALER 之间的转发循环
+    void runBroker();
+    void runWorker();
 
     // 创建响应
-    json createErrorResponse(int code, const std::string& message, int id = 0);
-    json createSuccessResponse(const json& result, int id);
+    json createErrorResponse(int code, const std::string& message, const json& id = nullptr);
+    json createSuccessResponse(const json& result, const json& id);
 
     // ZeroMQ相关
     zmq::context_t context_;
-    zmq::socket_t socket_;
-    bool running_ = false;
+    zmq::socket_t socket_;       // 单线程模式为 REP，多线程模式为前端 ROUTER
+    size_t worker_count_;
+    std::string backend_endpoint_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> workers_running_{false};
+    size_t batch_concurrency_ = 1;
+
+    // start 是否仍在执行，stop 据此等待服务循环退出；stop_requested_ 防止 stop 之后才开始的 start 进入服务循环
+    bool serving_ = false;
+    bool stop_requested_ = false;
+    std::mutex serving_mutex_;
+    std::condition_variable serving_cv_;
 
     // 方法处理器
     std::unordered_map<std::string, std::function<json(const json&)>> handlers_;
+    std::unordered_set<std::string> stream_methods_;   // 由 registerStreamMethod 注册的方法
+
+    // 打开的流
+    std::mutex streams_mutex_;
+    std::unordered_map<uint64_t, std::shared_ptr<StreamCursor>> streams_;
+    uint64_t next_stream_id_ = 1;
+    size_t stream_chunk_size_ = 100;
+    size_t max_streams_ = 64;
+    std::chrono::seconds stream_idle_timeout_{60};
 }; 
\ No newline at end of file
@@ -0,0 +1,368 @@
+// rpc_server_test.cpp
+// RPCServer 与客户端的协议行为，服务端与客户端在同一进程内经 ipc:// 通信
+#include "../../manager/alarm/tests/TestUtil.h"
+#include "rpc_server.hpp"
+#include "rpc_client.hpp"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using std::chrono::milliseconds;
+
+const size_t kChunkSize = 4;
+const size_t kMaxStreams = 3;
+const std::chrono::seconds kIdleTimeout(1);
+
+std::atomic<int> g_recorded{0};
+
+std::string endpointFor(const std::string& name) {
+    return "ipc:///tmp/rpc_server_test_" + name + "_" + std::to_string(getpid());
+}
+
+// 在后台线程上运行服务端，析构时停止
+class ServerRunner {
+public:
+    explicit ServerRunner(RPCServer& server) : server_(server), thread_([this] { server_.start(); }) {}
+    ~ServerRunner() {
+        server_.stop();
+        thread_.join();
+    }
+
+private:
+    RPCServer& server_;
+    std::thread thread_;
+};
+
+// 直接收发原始报文，用于检查客户端封装之外的应答格式
+class RawClient {
+public:
+    explicit RawClient(const std::string& endpoint) : context_(1), socket_(context_, ZMQ_REQ) {
+        socket_.connect(endpoint);
+    }
+
+    std::string request(const std::string& body) {
+        zmq::message_t message(body.data(), body.size());
+        socket_.send(message, zmq::send_flags::none);
+        zmq::message_t reply;
+        if (!socket_.recv(reply)) {
+            return std::string();
+        }
+        return std::string(static_cast<const char*>(reply.data()), reply.size());
+    }
+
+    json requestJson(const std::string& body) {
+        std::string reply = request(body);
+        return reply.empty() ? json() : json::parse(reply);
+    }
+
+private:
+    zmq::context_t context_;
+    zmq::socket_t socket_;
+};
+
+// ---- 多工作线程（ROUTER/DEALER）模式 ----
+
+void testStopBeforeStart() {
+    RPCServer server(endpointFor("idle"));
+    server.stop();
+    // stop 先于 start 时 start 立即返回，不进入服务循环
+    auto started = std::async(std::launch::async, [&server] { server.start(); });
+    CHECK(started.wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+}
+
+void testWorkers() {
+    const std::string endpoint = endpointFor("workers");
+    RPCServer server(endpoint, 4);
+    server.registerMethod("sleep", [](int ms) {
+        std::this_thread::sleep_for(milliseconds(ms));
+        return ms;
+    });
+    ServerRunner runner(server);
+
+    // 4个客户端各自发出一个耗时200ms的请求，多个工作线程并行处理
+    auto begin = Clock::now();
+    std::vector<std::future<json>> results;
+    for (int i = 0; i < 4; ++i) {
+        results.push_back(std::async(std::launch::async, [&endpoint] {
+            RPCClient client(endpoint);
+            return client.call("sleep", 200);
+        }));
+    }
+    for (auto& result : results) {
+        CHECK(result.get() == 200);
+    }
+    CHECK(Clock::now() - begin < milliseconds(600));
+}
+
+// ---- 单线程服务端上的协议测试 ----
+
+RPCServer::StreamProducer countTo(int n) {
+    auto next = std::make_shared<int>(0);
+    return [n, next](json& item) {
+        if (*next >= n) {
+            return false;
+        }
+        item = (*next)++;
+        return true;
+    };
+}
+
+void registerMethods(RPCServer& server) {
+    server.setBatchConcurrency(4);
+    server.setStreamChunkSize(kChunkSize);
+    server.setStreamLimits(kMaxStreams, kIdleTimeout);
+    server.registerMethod("echo", [](int x) { return x; });
+    // 越靠前的请求越慢，并发执行时完成顺序与请求顺序相反
+    server.registerMethod("slowEcho", [](int x) {
+        std::this_thread::sleep_for(milliseconds(2 * (16 - x)));
+        return x;
+    });
+    server.registerMethod("record", [](int x) {
+        g_recorded += x;
+        return true;
+    });
+    server.registerMethod("answer", []() { return 42; });
+    server.registerMethod("describe", [](const std::string& name, int count, double ratio) {
+        return name + ":" + std::to_string(count) + ":" + std::to_string(static_cast<int>(ratio * 100));
+    });
+    server.registerMethod("sum", [](std::vector<int> values) {
+        int total = 0;
+        for (int v : values) total += v;
+        return total;
+    });
+    server.registerMethod("fail", [](int) -> int { throw std::runtime_error("boom"); });
+    server.registerStreamMethod("count", [](int n) { return countTo(n); });
+}
+
+void testBatchOrder(RPCClient& client, RawClient& raw) {
+    std::vector<std::pair<std::string, json>> calls;
+    for (int i = 0; i < 16; ++i) {
+        calls.emplace_back("slowEcho", json::array({i}));
+    }
+    calls.emplace_back("missing", json::array());
+    json responses = client.callBatch(calls);
+    CHECK(responses.size() == 17);
+    for (int i = 0; i < 16; ++i) {
+        CHECK(responses[i]["result"] == i);
+    }
+    CHECK(responses[16]["error"]["code"] == -32601);
+
+    // 服务端应答本身即按请求顺序排列，通知不占位置，非法成员以 id 为 null 的错误应答
+    json reply = raw.requestJson(
+        R"([{"jsonrpc":"2.0","method":"slowEcho","params":[1],"id":"a"},)"
+        R"( {"jsonrpc":"2.0","method":"record","params":[5]},)"
+        R"( 42,)"
+        R"( {"jsonrpc":"2.0","method":"slowEcho","params":[15],"id":"b"},)"
+        R"( {"jsonrpc":"2.0","method":"echo","params":["x"],"id":"c"}])");
+    CHECK(reply.is_array() && reply.size() == 4);
+    if (reply.is_array() && reply.size() == 4) {
+        CHECK(reply[0]["id"] == "a" && reply[0]["result"] == 1);
+        CHECK(reply[1]["id"].is_null() && reply[1]["error"]["code"] == -32600);
+        CHECK(reply[2]["id"] == "b" && reply[2]["result"] == 15);
+        CHECK(reply[3]["id"] == "c" && reply[3]["error"]["code"] == -32602);
+    }
+}
+
+void testNotifications(RPCClient& client, RawClient& raw) {
+    g_recorded = 0;
+    client.notify("record", 2);
+    // 单个通知与全为通知的批都以空消息应答，但方法照常执行
+    CHECK(raw.request(R"({"jsonrpc":"2.0","method":"record","params":[3]})").empty());
+    CHECK(raw.request(R"([{"jsonrpc":"2.0","method":"record","params":[4]},)"
+                      R"( {"jsonrpc":"2.0","method":"missing"}])").empty());
+    CHECK(g_recorded == 9);
+}
+
+void testErrors(RawClient& raw) {
+    json reply = raw.requestJson("[]");
+    CHECK(reply["error"]["code"] == -32600);
+    reply = raw.requestJson("{not json");
+    CHECK(reply["error"]["code"] == -32700);
+    reply = raw.requestJson(R"({"jsonrpc":"1.0","method":"echo","params":[1],"id":1})");
+    CHECK(reply["error"]["code"] == -32600);
+    reply = raw.requestJson(R"({"jsonrpc":"2.0","method":"fail","params":[1],"id":1})");
+    CHECK(reply["error"]["code"] == -32000);
+}
+
+void testMsgpack(const std::string& endpoint) {
+    RPCClient client(endpoint, RpcEncoding::MSGPACK);
+    CHECK(client.call("echo", 5) == 5);
+    CHECK(client.call("describe", "cpu", 3, 0.5) == "cpu:3:50");
+    json responses = client.callBatch({{"echo", json::array({1})}, {"missing", json::array()}});
+    CHECK(responses.size() == 2 && responses[0]["result"] == 1 && responses[1]["error"]["code"] == -32601);
+
+    // 服务端按请求的编码应答
+    zmq::context_t context(1);
+    zmq::socket_t socket(context, ZMQ_REQ);
+    socket.connect(endpoint);
+    json request = {{"jsonrpc", "2.0"}, {"method", "echo"}, {"params", {7}}, {"id", 1}};
+    zmq::message_t message = rpc_codec::encode(request, RpcEncoding::MSGPACK);
+    socket.send(message, zmq::send_flags::none);
+    zmq::message_t reply;
+    CHECK(socket.recv(reply));
+    CHECK(rpc_codec::detectEncoding(reply) == RpcEncoding::MSGPACK);
+    CHECK(rpc_codec::decode(reply)["result"] == 7);
+}
+
+void testArity(RPCClient& client, RawClient& raw) {
+    CHECK(client.call("answer") == 42);
+    CHECK(client.call("describe", "mem", 2, 0.25) == "mem:2:25");
+    CHECK(client.call("sum", std::vector<int>{1, 2, 3}) == 6);
+    // 无参方法可省略 params
+    CHECK(raw.requestJson(R"({"jsonrpc":"2.0","method":"answer","id":1})")["result"] == 42);
+    // 参数个数或类型不符
+    CHECK(raw.requestJson(R"({"jsonrpc":"2.0","method":"describe","params":["a",1],"id":1})")["error"]["code"] == -32602);
+    CHECK(raw.requestJson(R"({"jsonrpc":"2.0","method":"describe","params":[1,1,1],"id":1})")["error"]["code"] == -32602);
+    CHECK(raw.requestJson(R"({"jsonrpc":"2.0","method":"sum","params":[[1,"x"]],"id":1})")["error"]["code"] == -32602);
+    CHECK(raw.requestJson(R"({"jsonrpc":"2.0","method":"answer","params":[1],"id":1})")["error"]["code"] == -32602);
+}
+
+void testAsyncClient(const std::string& endpoint) {
+    AsyncRPCClient client(endpoint, std::chrono::seconds(5));
+    std::vector<std::future<json>> results;
+    for (int i = 0; i < 50; ++i) {
+        results.push_back(client.callAsync("echo", i));
+    }
+    for (int i = 0; i < 50; ++i) {
+        CHECK(results[i].get() == i);
+    }
+
+    // 超时与错误以异常形式交给 future
+    auto slow = client.callAsyncFor(milliseconds(5), "slowEcho", 0);
+    CHECK_THROWS(slow.get(), std::runtime_error);
+    auto failed = client.callAsync("fail", 1);
+    CHECK_THROWS(failed.get(), std::runtime_error);
+
+    // 回调抛出的异常不影响之后的调用
+    std::promise<void> called;
+    client.callAsyncThen([&called](const json&, std::exception_ptr) {
+        called.set_value();
+        throw std::runtime_error("callback failed");
+    }, std::chrono::seconds(5), "echo", 1);
+    CHECK(called.get_future().wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+    CHECK(client.callAsync("echo", 2).get() == 2);
+
+    // 停止后的调用在提交时即失败
+    client.stop();
+    auto closed = client.callAsync("echo", 3);
+    CHECK(closed.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+    CHECK_THROWS(closed.get(), std::runtime_error);
+}
+
+void testStreamChunks(RPCClient& client) {
+    // 元素数不足一段：首个应答即结束，不占用流
+    json first = client.call("count", 3);
+    CHECK(first["done"] == true && first["stream"].is_null() && first["items"].size() == 3);
+
+    // 恰为段长的整数倍：生成器在最后一段之后才报告结束，末段为空
+    first = client.call("count", 2 * static_cast<int>(kChunkSize));
+    CHECK(first["done"] == false && first["items"].size() == kChunkSize);
+    json id = first["stream"];
+    json second = client.call("rpc.stream.next", id);
+    CHECK(second["done"] == false && second["stream"] == id && second["items"].size() == kChunkSize);
+    json last = client.call("rpc.stream.next", id);
+    CHECK(last["done"] == true && last["stream"].is_null() && last["items"].empty());
+    // 结束后流已释放
+    CHECK_THROWS(client.call("rpc.stream.next", id), std::runtime_error);
+
+    // 客户端封装逐个取出全部元素
+    auto stream = client.callStream("count", 10);
+    json item;
+    int expected = 0;
+    while (stream.next(item)) {
+        CHECK(item == expected);
+        ++expected;
+    }
+    CHECK(expected == 10);
+
+    CHECK_THROWS(client.call("rpc.stream.next", 123456), std::runtime_error);
+    CHECK(client.call("rpc.stream.close", 123456) == false);
+}
+
+void testStreamRestrictions(RPCClient& client, RawClient& raw) {
+    // 批请求与通知中的流式方法不创建流：之后仍能打开 kMaxStreams 个流
+    json reply = raw.requestJson(R"([{"jsonrpc":"2.0","method":"count","params":[100],"id":1},)"
+                                 R"( {"jsonrpc":"2.0","method":"echo","params":[7],"id":2}])");
+    CHECK(reply.is_array() && reply.size() == 2);
+    if (reply.is_array() && reply.size() == 2) {
+        CHECK(reply[0]["error"]["code"] == -32600);
+        CHECK(reply[1]["result"] == 7);
+    }
+    CHECK(raw.request(R"({"jsonrpc":"2.0","method":"count","params":[100]})").empty());
+
+    std::vector<json> ids;
+    for (size_t i = 0; i < kMaxStreams; ++i) {
+        ids.push_back(client.call("count", 100)["stream"]);
+    }
+    CHECK_THROWS(client.call("count", 100), std::runtime_error);
+
+    // 显式关闭释放名额
+    CHECK(client.call("rpc.stream.close", ids.back()) == true);
+    CHECK(client.call("rpc.stream.close", ids.back()) == false);
+    ids.pop_back();
+    {
+        // 未取完就销毁的 Stream 在析构时关闭服务端的流
+        auto stream = client.callStream("count", 100);
+        json item;
+        CHECK(stream.next(item));
+    }
+    ids.push_back(client.call("count", 100)["stream"]);
+    CHECK_THROWS(client.call("count", 100), std::runtime_error);
+
+    // 空闲超时后的流在下次打开流时被清理
+    std::this_thread::sleep_for(kIdleTimeout + milliseconds(200));
+    json fresh = client.call("count", 100);
+    CHECK(!fresh["stream"].is_null());
+    for (const auto& id : ids) {
+        CHECK_THROWS(client.call("rpc.stream.next", id), std::runtime_error);
+    }
+    client.call("rpc.stream.close", fresh["stream"]);
+}
+
+void testStreamMsgpack(const std::string& endpoint) {
+    RPCClient client(endpoint, RpcEncoding::MSGPACK);
+    auto stream = client.callStream("count", 6);
+    json item;
+    int n = 0;
+    while (stream.next(item)) ++n;
+    CHECK(n == 6);
+}
+
+} // namespace
+
+int main() {
+    testStopBeforeStart();
+    testWorkers();
+
+    const std::string endpoint = endpointFor("protocol");
+    RPCServer server(endpoint);
+    registerMethods(server);
+    {
+        ServerRunner runner(server);
+        RPCClient client(endpoint);
+        RawClient raw(endpoint);
+        testBatchOrder(client, raw);
+        testNotifications(client, raw);
+        testErrors(raw);
+        testMsgpack(endpoint);
+        testArity(client, raw);
+        testAsyncClient(endpoint);
+        testStreamChunks(client);
+        testStreamRestrictions(client, raw);
+        testStreamMsgpack(endpoint);
+    }
+
+    for (const char* name : {"idle", "workers", "protocol"}) {
+        ::unlink(endpointFor(name).substr(6).c_str());
+    }
+    return TEST_RESULT();
+}